@@ -0,0 +1,402 @@
+/*
+ * Fixed-memory trace analysis implementations for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Libraries and Files
+#include "Analysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "Arguments.h"
+#include "Simulator.h"
+#include "Trace.h"
+
+// Statements
+using std::cerr;
+using std::cin;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+// Sketch sizes, fixed whatever the length of the trace
+static const int HLL_PRECISION = 14;  // 16 KB per estimate, about 0.8% error
+static const int CM_DEPTH = 4;
+static const int CM_WIDTH = 1 << 16;  // 1 MB of counters
+// Ways used for suggested geometries
+static const int SUGGESTED_WAYS = 4;
+
+/*
+ * Mixes a value into a 64-bit hash (the splitmix64 finalizer).
+ */
+static uint64_t mix(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+/*
+ * Constructor for the HyperLogLog class. Every register starts at 0.
+ *
+ * Parameters:
+ *   precision - Index bits, giving 2^precision registers
+ */
+HyperLogLog::HyperLogLog(int precision) : precision(precision), registers((size_t)1 << precision) {}
+
+/*
+ * Adds a value.
+ *
+ * Parameters:
+ *   hash - A well mixed 64-bit hash of the value
+ */
+void HyperLogLog::add(uint64_t hash) {
+    size_t index = hash >> (64 - precision);
+    uint64_t rest = hash << precision;
+    // position of the first 1 bit after the index bits
+    uint8_t rank = rest == 0 ? 64 - precision + 1 : __builtin_clzll(rest) + 1;
+    registers[index] = std::max(registers[index], rank);
+}
+
+/*
+ * Estimates the number of distinct values added since the last clear().
+ */
+double HyperLogLog::estimate() const {
+    double m = registers.size();
+    double sum = 0;
+    int zeros = 0;
+    for (uint8_t rank : registers) {
+        sum += std::ldexp(1.0, -rank);
+        zeros += rank == 0;
+    }
+    double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    // small counts are more accurate from the share of empty registers
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / zeros);
+    }
+    return estimate;
+}
+
+void HyperLogLog::clear() {
+    std::fill(registers.begin(), registers.end(), 0);
+}
+
+/*
+ * Constructor for the CountMinSketch class. Every counter starts at 0.
+ *
+ * Parameters:
+ *   depth - Number of rows, each with its own hash
+ *   width - Counters per row, a power of two
+ */
+CountMinSketch::CountMinSketch(int depth, int width)
+    : depth(depth), width(width), counters((size_t)depth * width)
+{
+}
+
+/*
+ * Counts one occurrence of a value.
+ *
+ * Parameters:
+ *   value - The value seen
+ *
+ * Returns:
+ *   The value's estimated count after this occurrence.
+ */
+uint32_t CountMinSketch::add(uint32_t value) {
+    uint64_t hash = mix(value);
+    // each row takes its column from a different 16-bit slice of the hash
+    uint32_t least = UINT32_MAX;
+    for (int row = 0; row < depth; ++row) {
+        least = std::min(least, counters[(size_t)row * width + ((hash >> (row * 16)) & (width - 1))]);
+    }
+    // conservative update: only raise counters that are below the new estimate
+    for (int row = 0; row < depth; ++row) {
+        uint32_t &cell = counters[(size_t)row * width + ((hash >> (row * 16)) & (width - 1))];
+        cell = std::max(cell, least + 1);
+    }
+    return least + 1;
+}
+
+/*
+ * Constructor for the HeavyHitters class.
+ *
+ * Parameters:
+ *   top - Number of candidates kept
+ */
+HeavyHitters::HeavyHitters(int top) : sketch(CM_DEPTH, CM_WIDTH), limit(top), smallest(0) {}
+
+void HeavyHitters::add(uint32_t value) {
+    uint32_t count = sketch.add(value);
+    auto found = slots.find(value);
+    if (found != slots.end()) {
+        counts[found->second] = count;
+        if (found->second == smallest) {
+            findSmallest();
+        }
+        return;
+    }
+    if ((int)values.size() < limit) {
+        slots[value] = values.size();
+        values.push_back(value);
+        counts.push_back(count);
+        findSmallest();
+        return;
+    }
+    if (limit == 0 || count <= counts[smallest]) {
+        return;
+    }
+    // the new value overtakes the weakest candidate
+    slots.erase(values[smallest]);
+    slots[value] = smallest;
+    values[smallest] = value;
+    counts[smallest] = count;
+    findSmallest();
+}
+
+/*
+ * Lists the candidates, most frequent first.
+ *
+ * Returns:
+ *   Pairs of value and estimated count.
+ */
+vector<std::pair<uint32_t, uint32_t>> HeavyHitters::top() const {
+    vector<std::pair<uint32_t, uint32_t>> result;
+    for (size_t i = 0; i < values.size(); ++i) {
+        result.emplace_back(values[i], counts[i]);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const std::pair<uint32_t, uint32_t> &a, const std::pair<uint32_t, uint32_t> &b) {
+                  return a.second > b.second;
+              });
+    return result;
+}
+
+void HeavyHitters::findSmallest() {
+    smallest = 0;
+    for (size_t i = 1; i < counts.size(); ++i) {
+        if (counts[i] < counts[smallest]) {
+            smallest = i;
+        }
+    }
+}
+
+// Estimates kept for one block size
+struct BlockSizeSketch {
+    int size;
+    int offsetBits;
+    HyperLogLog total;
+    // two windows open at once, one starting half a window after the other,
+    // so windows slide by half their length
+    HyperLogLog open[2];
+    uint64_t opened[2];  // accesses seen when each open window started
+    double windowSum;
+    double windowPeak;
+    uint64_t windows;
+
+    explicit BlockSizeSketch(int size)
+        : size(size), offsetBits(log2(size)), total(HLL_PRECISION),
+          open{HyperLogLog(HLL_PRECISION), HyperLogLog(HLL_PRECISION)}, opened{0, 0}, windowSum(0),
+          windowPeak(0), windows(0)
+    {
+    }
+
+    void add(uint64_t hash) {
+        total.add(hash);
+        open[0].add(hash);
+        open[1].add(hash);
+    }
+
+    // restarts an open window without measuring it
+    void startWindow(int which, uint64_t accesses) {
+        open[which].clear();
+        opened[which] = accesses;
+    }
+
+    // measures an open window and starts the next one in its place
+    void endWindow(int which, uint64_t accesses) {
+        double blocks = open[which].estimate();
+        windowSum += blocks;
+        windowPeak = std::max(windowPeak, blocks);
+        windows++;
+        startWindow(which, accesses);
+    }
+};
+
+/*
+ * Reads the analysis options that follow --analyze.
+ *
+ * Returns:
+ *   True if every option is valid, False otherwise.
+ */
+static bool parseAnalysisOptions(int argc, char *argv[], vector<int> &sizes, uint64_t &window, int &top) {
+    for (int i = 2; i < argc; ++i) {
+        string flag = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (flag == "--block-sizes" && hasValue) {
+            sizes.clear();
+            for (const string &size : splitList(argv[++i])) {
+                sizes.push_back(std::atoi(size.c_str()));
+                if (!isPowerOfTwo(sizes.back()) || sizes.back() < 4) {
+                    cerr << "ERROR: Block size (" << size << ") is not a power of 2 of at least 4 bytes." << endl;
+                    return false;
+                }
+            }
+        } else if (flag == "--window" && hasValue) {
+            window = std::strtoull(argv[++i], nullptr, 10);
+            if (window == 0) {
+                cerr << "ERROR: Window (" << argv[i] << ") must be a positive number of accesses." << endl;
+                return false;
+            }
+        } else if (flag == "--top" && hasValue) {
+            top = std::atoi(argv[++i]);
+            if (top <= 0) {
+                cerr << "ERROR: Hot block count (" << argv[i] << ") must be a positive integer." << endl;
+                return false;
+            }
+        } else {
+            cerr << "ERROR: Unknown option " << flag << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Finds the smallest power of two number of blocks that holds a given
+ * number, capped at a gigabyte of cache.
+ */
+static int capacityFor(int size, double blocks) {
+    int capacity = 1;
+    while (capacity < blocks && capacity < (1 << 30) / size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+/*
+ * Prints a geometry of SUGGESTED_WAYS ways that holds at least a number of
+ * blocks, in the order the command line takes it.
+ */
+static void suggest(int size, double blocks, const string &reason) {
+    int capacity = capacityFor(size, blocks);
+    int ways = std::min(capacity, SUGGESTED_WAYS);
+    cout << "  " << capacity / ways << " " << ways << " " << size << " (" << (uint64_t)capacity * size
+         << " bytes, " << reason << ")" << endl;
+}
+
+/*
+ * Entry point for `csim --analyze [options] < trace`. Reads a text trace or
+ * a miss stream once and reports distinct blocks, working sets and hot
+ * blocks for several block sizes, then suggests cache geometries.
+ */
+int runAnalysis(int argc, char *argv[]) {
+    vector<int> sizes = {16, 32, 64, 128};
+    uint64_t window = 100000;
+    int top = 10;
+    if (!parseAnalysisOptions(argc, argv, sizes, window, top)) {
+        cerr << "Usage: " << argv[0] << " --analyze [--block-sizes <b0>,...] [--window <accesses>] [--top <blocks>]"
+             << endl;
+        return 1;
+    }
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    vector<BlockSizeSketch> sketches(sizes.begin(), sizes.end());
+    // hot blocks are counted at the smallest block size
+    HeavyHitters hot(top);
+    int hotBits = sketches[0].offsetBits;
+
+    TraceReader reader(cin);
+    AccessRecord record;
+    uint64_t sequence;
+    uint64_t accesses = 0;
+    int status;
+    // the second window starts this many accesses after the first
+    uint64_t stagger = window / 2;
+    while ((status = reader.next(record, sequence)) == 1) {
+        for (BlockSizeSketch &sketch : sketches) {
+            sketch.add(mix(blockNumber(record.address, sketch.offsetBits)));
+        }
+        hot.add(blockNumber(record.address, hotBits));
+        uint64_t phase = ++accesses % window;
+        for (BlockSizeSketch &sketch : sketches) {
+            if (phase == 0) {
+                sketch.endWindow(0, accesses);
+            }
+            // the staggered window's first stretch is shorter than a window, so it is not measured
+            if (stagger > 0 && phase == stagger) {
+                if (accesses > window) {
+                    sketch.endWindow(1, accesses);
+                } else {
+                    sketch.startWindow(1, accesses);
+                }
+            }
+        }
+    }
+    if (status < 0) {
+        cerr << reader.error() << endl;
+        return 1;
+    }
+    // accesses after the last full first window are measured by the older
+    // open window, which covers all of them, so a short trace is one window
+    if (accesses % window != 0) {
+        for (BlockSizeSketch &sketch : sketches) {
+            bool staggered = stagger > 0 && accesses > stagger && sketch.opened[1] < sketch.opened[0];
+            sketch.endWindow(staggered ? 1 : 0, accesses);
+        }
+    }
+
+    cout << std::fixed << std::setprecision(0);
+    cout << "Total accesses: " << accesses << endl;
+    cout << "Sketch memory: "
+         << sketches.size() * 3 * ((size_t)1 << HLL_PRECISION) + (size_t)CM_DEPTH * CM_WIDTH * sizeof(uint32_t)
+         << " bytes" << endl;
+    for (BlockSizeSketch &sketch : sketches) {
+        double unique = sketch.total.estimate();
+        double average = sketch.windows == 0 ? 0 : sketch.windowSum / sketch.windows;
+        cout << "Block size " << sketch.size << ": unique blocks ~" << unique << " (~" << unique * sketch.size
+             << " bytes)" << endl;
+        cout << "Block size " << sketch.size << ": working set per " << window << " accesses (sliding by "
+             << window - stagger << ") ~" << average << " blocks average, ~"
+             << sketch.windowPeak << " blocks peak" << endl;
+    }
+    vector<std::pair<uint32_t, uint32_t>> hottest = hot.top();
+    uint64_t hotAccesses = 0;
+    cout << "Hot " << sketches[0].size << "-byte blocks:" << endl;
+    for (const std::pair<uint32_t, uint32_t> &entry : hottest) {
+        hotAccesses += entry.second;
+        cout << "  0x" << std::hex << std::setw(8) << std::setfill('0') << (entry.first << hotBits) << std::dec
+             << std::setfill(' ') << " ~" << entry.second << " accesses" << endl;
+    }
+    double hotShare = accesses == 0 ? 0 : 100.0 * std::min<uint64_t>(hotAccesses, accesses) / accesses;
+    cout << "Hot blocks share of accesses: ~" << std::setprecision(2) << hotShare << "%" << std::setprecision(0)
+         << endl;
+
+    // Suggest geometries that hold the working set, or the whole footprint if it is smaller
+    cout << "Suggested geometries (sets blocks size):" << endl;
+    for (BlockSizeSketch &sketch : sketches) {
+        double unique = sketch.total.estimate();
+        double average = sketch.windows == 0 ? 0 : sketch.windowSum / sketch.windows;
+        if (unique <= sketch.windowPeak * 1.05) {
+            suggest(sketch.size, unique, "holds every block of the trace");
+            continue;
+        }
+        if (capacityFor(sketch.size, average) == capacityFor(sketch.size, sketch.windowPeak)) {
+            suggest(sketch.size, sketch.windowPeak, "holds the average and peak working set");
+            continue;
+        }
+        suggest(sketch.size, average, "holds the average working set");
+        suggest(sketch.size, sketch.windowPeak, "holds the peak working set");
+    }
+    if (hotShare >= 50) {
+        suggest(sketches[0].size, hottest.size(), "holds the hot blocks");
+    }
+    return 0;
+}
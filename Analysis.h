@@ -0,0 +1,115 @@
+/*
+ * Fixed-memory trace analysis for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Guards
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+// Libraries and Files
+#include <stdint.h>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Class Definitions
+/*
+ * HyperLogLog estimate of the number of distinct values added. It keeps
+ * 2^precision one-byte registers, so memory does not depend on the trace,
+ * and the estimate's standard error is about 1.04 / sqrt(2^precision).
+ */
+class HyperLogLog {
+ public:
+  explicit HyperLogLog(int precision);
+
+/*
+ * Adds a value.
+ *
+ * Parameters:
+ *   hash - A well mixed 64-bit hash of the value
+ */
+  void add(uint64_t hash);
+
+/*
+ * Estimates the number of distinct values added since the last clear().
+ */
+  double estimate() const;
+
+  void clear();
+
+ private:
+  int precision;
+  std::vector<uint8_t> registers;
+};
+
+/*
+ * Count-Min sketch with conservative update. Estimates never undercount,
+ * and overcount by a small share of the total for all but unlucky values.
+ * Rows index with 16-bit slices of one hash, so depth is at most 4 and
+ * width at most 2^16.
+ */
+class CountMinSketch {
+ public:
+  CountMinSketch(int depth, int width);
+
+/*
+ * Counts one occurrence of a value.
+ *
+ * Parameters:
+ *   value - The value seen
+ *
+ * Returns:
+ *   The value's estimated count after this occurrence.
+ */
+  uint32_t add(uint32_t value);
+
+ private:
+  int depth;
+  int width;  // a power of two
+  std::vector<uint32_t> counters;
+};
+
+/*
+ * Tracks the most frequent values of a stream: a Count-Min sketch estimates
+ * every value's count, and the values with the largest estimates so far
+ * are kept as candidates.
+ */
+class HeavyHitters {
+ public:
+  explicit HeavyHitters(int top);
+
+  void add(uint32_t value);
+
+/*
+ * Lists the candidates, most frequent first.
+ *
+ * Returns:
+ *   Pairs of value and estimated count.
+ */
+  std::vector<std::pair<uint32_t, uint32_t>> top() const;
+
+ private:
+  /* Variables */
+  CountMinSketch sketch;
+  int limit;
+  std::vector<uint32_t> values;
+  std::vector<uint32_t> counts;
+  std::unordered_map<uint32_t, int> slots;  // candidate value to its place
+  int smallest;                             // place of the smallest count
+
+  /* Methods */
+  void findSmallest();
+};
+
+/*
+ * Entry point for `csim --analyze [options] < trace`. Reads a text trace or
+ * a miss stream once and reports distinct blocks, working sets and hot
+ * blocks for several block sizes, then suggests cache geometries.
+ */
+int runAnalysis(int argc, char *argv[]);
+
+#endif
@@ -0,0 +1,433 @@
+/*
+ * Command line argument parsing implementations for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Libraries and Files
+#include "Arguments.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+
+/*
+ * Builds a Simulator from the usual csim command line arguments
+ * (<# of sets> <# of blocks> <block size> <miss> <write> <eviction> [options]).
+ *
+ * Parameters:
+ *   argc - The number of command line arguments
+ *   argv - The array of command line arguments
+ *
+ * Returns:
+ *   The configured Simulator, or nullptr if any argument is invalid.
+ */
+std::unique_ptr<Simulator> buildSimulator(int argc, char *argv[]) {
+    if (!validateArguments(argc, argv)) {
+        return nullptr;
+    }
+    int sets, blocks, size;
+    string miss, write, eviction;
+    if (!parseInputParameters(sets, blocks, size, miss, write, eviction, argv)) {
+        return nullptr;
+    }
+    WriteMissPolicy missPolicy;
+    if (!convertMissPolicy(miss, missPolicy)) {
+        cerr << "Invalid miss policy." << endl;
+        return nullptr;
+    }
+    WritePolicy writePolicy;
+    if (!convertWritePolicy(write, miss, writePolicy)) {
+        cerr << "Invalid write policy." << endl;
+        return nullptr;
+    }
+    EvictionPolicy evictionPolicy;
+    if (!convertEvictionPolicy(eviction, evictionPolicy)) {
+        cerr << "Invalid eviction policy." << endl;
+        return nullptr;
+    }
+    SimOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return nullptr;
+    }
+    if (evictionPolicy == EvictionPolicy::OPT && options.tlb) {
+        // page walk reads are not in the trace, so they have no next use
+        cerr << "ERROR: opt eviction cannot be combined with the TLB model." << endl;
+        return nullptr;
+    }
+    if (evictionPolicy == EvictionPolicy::OPT && !options.tenantTraces.empty()) {
+        cerr << "ERROR: opt eviction cannot be combined with tenant traces." << endl;
+        return nullptr;
+    }
+    if (!validateTenants(blocks, options)) {
+        return nullptr;
+    }
+    if (options.sectorSize > size || (options.sectorSize > 0 && size / options.sectorSize > 64)) {
+        cerr << "ERROR: Sector size (" << options.sectorSize << ") must fit in a block and split it into at most 64 sectors."
+             << endl;
+        return nullptr;
+    }
+    return std::unique_ptr<Simulator>(
+        new Simulator(sets, blocks, size, missPolicy, writePolicy, evictionPolicy, options));
+}
+
+/*
+ * Converts a string representation of the miss policy to its corresponding enum value.
+ *
+ * Parameters:
+ *   miss - The string representation of the miss policy
+ *   missPolicy - Reference to the WriteMissPolicy enum to store the converted value
+ *
+ * Returns:
+ *   True if the conversion is successful, False otherwise.
+ */
+bool convertMissPolicy(const string &miss, WriteMissPolicy &missPolicy) {
+    if (miss == "write-allocate") {
+        missPolicy = WriteMissPolicy::WriteAllocate;
+        return true;
+    } else if (miss == "no-write-allocate") {
+        missPolicy = WriteMissPolicy::NoWriteAllocate;
+        return true;
+    }
+    return false; // Indicate failure to convert
+}
+
+/*
+ * Converts a string representation of the write policy to its corresponding enum value.
+ *
+ * Parameters:
+ *   write - The string representation of the write policy
+ *   miss - The string representation of the miss policy, used for validation
+ *   writePolicy - Reference to the WritePolicy enum to store the converted value
+ *
+ * Returns:
+ *   True if the conversion is successful, False otherwise.
+ */
+bool convertWritePolicy(const string &write, const string &miss, WritePolicy &writePolicy) {
+    if (write == "write-back") {
+        if (miss == "no-write-allocate") {
+            cerr << "write-back and no-write-allocate cannot be specified together" << endl;
+            return false;
+        }
+        writePolicy = WritePolicy::WriteBack;
+        return true;
+    } else if (write == "write-through") {
+        writePolicy = WritePolicy::WriteThrough;
+        return true;
+    }
+    return false; // Indicate failure to convert
+}
+
+/*
+ * Converts a string representation of the eviction policy to its corresponding enum value.
+ *
+ * Parameters:
+ *   eviction - The string representation of the eviction policy
+ *   evictionPolicy - Reference to the EvictionPolicy enum to store the converted value
+ *
+ * Returns:
+ *   True if the conversion is successful, False otherwise.
+ */
+bool convertEvictionPolicy(const string &eviction, EvictionPolicy &evictionPolicy) {
+    if (eviction == "fifo") {
+        evictionPolicy = EvictionPolicy::FIFO;
+        return true;
+    } else if (eviction == "lru") {
+        evictionPolicy = EvictionPolicy::LRU;
+        return true;
+    } else if (eviction == "opt") {
+        evictionPolicy = EvictionPolicy::OPT;
+        return true;
+    }
+    return false; // Indicate failure to convert
+}
+
+/*
+ * Parses the optional flags that follow the six required arguments.
+ *
+ * Parameters:
+ *   argc - The number of command line arguments
+ *   argv - The array of command line arguments
+ *   options - Reference to the SimOptions to fill in
+ *
+ * Returns:
+ *   True if every flag is recognized, False otherwise.
+ */
+bool parseOptions(int argc, char *argv[], SimOptions &options) {
+    for (int i = 7; i < argc; ++i) {
+        string flag = argv[i];
+        // flags that take a value read it from the next argument
+        bool hasValue = i + 1 < argc;
+        if (flag == "--compact") {
+            options.compact = true;
+        } else if (flag == "--tlb") {
+            options.tlb = true;
+        } else if (flag == "--tlb-l1" && hasValue) {
+            options.tlb = true;
+            if (!parseTlbGeometry(argv[++i], options.tlbConfig.l1Entries, options.tlbConfig.l1Ways, false)) {
+                return false;
+            }
+        } else if (flag == "--tlb-l2" && hasValue) {
+            options.tlb = true;
+            if (!parseTlbGeometry(argv[++i], options.tlbConfig.l2Entries, options.tlbConfig.l2Ways, true)) {
+                return false;
+            }
+        } else if (flag == "--huge-pages" && hasValue) {
+            options.tlb = true;
+            options.tlbConfig.pageSize = std::atoi(argv[++i]);
+            if (!isPowerOfTwo(options.tlbConfig.pageSize) || options.tlbConfig.pageSize <= 4096) {
+                cerr << "ERROR: Huge page size (" << argv[i] << ") is not a power of 2 larger than 4096." << endl;
+                return false;
+            }
+        } else if (flag == "--sector-size" && hasValue) {
+            options.sectorSize = std::atoi(argv[++i]);
+            if (!isPowerOfTwo(options.sectorSize) || options.sectorSize < 4) {
+                cerr << "ERROR: Sector size (" << argv[i] << ") is not a power of 2 of at least 4 bytes." << endl;
+                return false;
+            }
+        } else if (flag == "--miss-stream" && hasValue) {
+            options.missStream = argv[++i];
+        } else if (flag == "--tenant" && hasValue) {
+            options.tenantTraces.push_back(argv[++i]);
+        } else if (flag == "--schedule" && hasValue) {
+            if (!parseSchedule(argv[++i], options)) {
+                return false;
+            }
+        } else if (flag == "--partition" && hasValue) {
+            options.wayMasks.clear();
+            for (const string &mask : splitList(argv[++i])) {
+                options.wayMasks.push_back(std::strtoull(mask.c_str(), nullptr, 16));
+            }
+        } else {
+            cerr << "ERROR: Unknown option " << flag << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Splits a comma separated list.
+ *
+ * Parameters:
+ *   value - The list
+ *
+ * Returns:
+ *   The items in order.
+ */
+std::vector<string> splitList(const string &value) {
+    std::vector<string> items;
+    size_t start = 0;
+    while (true) {
+        size_t comma = value.find(',', start);
+        items.push_back(value.substr(start, comma - start));
+        if (comma == string::npos) {
+            return items;
+        }
+        start = comma + 1;
+    }
+}
+
+/*
+ * Parses a tenant schedule: rr, timestamp, or weighted:<w0>,<w1>,...
+ *
+ * Parameters:
+ *   value - The schedule string
+ *   options - Reference to the SimOptions to fill in
+ *
+ * Returns:
+ *   True if the schedule is valid, False otherwise.
+ */
+bool parseSchedule(const string &value, SimOptions &options) {
+    if (value == "rr") {
+        options.schedule = TenantSchedule::RoundRobin;
+        return true;
+    }
+    if (value == "timestamp") {
+        options.schedule = TenantSchedule::Timestamp;
+        return true;
+    }
+    if (value.compare(0, 9, "weighted:") == 0) {
+        options.schedule = TenantSchedule::Weighted;
+        options.tenantWeights.clear();
+        for (const string &weight : splitList(value.substr(9))) {
+            options.tenantWeights.push_back(std::atoi(weight.c_str()));
+            if (options.tenantWeights.back() <= 0) {
+                cerr << "ERROR: Tenant weight (" << weight << ") must be a positive integer." << endl;
+                return false;
+            }
+        }
+        return true;
+    }
+    cerr << "ERROR: Unknown schedule " << value << " (expected rr, timestamp or weighted:<w0>,<w1>,...)." << endl;
+    return false;
+}
+
+/*
+ * Checks the tenant options against each other and the cache geometry.
+ *
+ * Parameters:
+ *   blocks - Number of blocks in each set
+ *   options - The parsed options
+ *
+ * Returns:
+ *   True if the tenant options are consistent, False otherwise.
+ */
+bool validateTenants(int blocks, const SimOptions &options) {
+    size_t tenants = options.tenantTraces.size();
+    if (tenants == 0) {
+        if (!options.wayMasks.empty() || options.schedule != TenantSchedule::RoundRobin) {
+            cerr << "ERROR: --schedule and --partition need at least one --tenant trace." << endl;
+            return false;
+        }
+        return true;
+    }
+    if (options.schedule == TenantSchedule::Weighted && options.tenantWeights.size() != tenants) {
+        cerr << "ERROR: Expected " << tenants << " tenant weights, got " << options.tenantWeights.size() << "." << endl;
+        return false;
+    }
+    if (options.wayMasks.empty()) {
+        return true;
+    }
+    if (options.wayMasks.size() != tenants) {
+        cerr << "ERROR: Expected " << tenants << " way masks, got " << options.wayMasks.size() << "." << endl;
+        return false;
+    }
+    if (blocks > 64) {
+        cerr << "ERROR: Way partitioning supports at most 64 blocks per set." << endl;
+        return false;
+    }
+    uint64_t ways = blocks == 64 ? ~0ULL : (1ULL << blocks) - 1;
+    for (uint64_t mask : options.wayMasks) {
+        if ((mask & ways) == 0) {
+            cerr << "ERROR: Every way mask needs at least one of the cache's " << blocks << " ways." << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Parses a TLB level's geometry given as <entries>:<ways>.
+ *
+ * Parameters:
+ *   value - The geometry string
+ *   entries - Reference to the number of entries
+ *   ways - Reference to the number of ways
+ *   allowEmpty - Whether 0 entries (no such level) is allowed
+ *
+ * Returns:
+ *   True if the geometry is valid, False otherwise.
+ */
+bool parseTlbGeometry(const string &value, int &entries, int &ways, bool allowEmpty) {
+    size_t colon = value.find(':');
+    if (colon == string::npos) {
+        cerr << "ERROR: TLB geometry (" << value << ") must be <entries>:<ways>." << endl;
+        return false;
+    }
+    entries = std::atoi(value.substr(0, colon).c_str());
+    ways = std::atoi(value.substr(colon + 1).c_str());
+    if (entries == 0 && allowEmpty) {
+        return true;
+    }
+    if (entries <= 0 || ways <= 0 || entries % ways != 0) {
+        cerr << "ERROR: TLB geometry (" << value << ") needs a positive number of entries divisible by ways." << endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+* Checks if a number is a power of 2.
+* 
+* Parameters:
+*   x - The number to check
+*
+* Returns:
+*  True if the number is a power of 2, False otherwise.
+*/
+bool isPowerOfTwo(int x) {
+    return x && !(x & (x - 1));
+}
+
+/*
+ * Parses input parameters from command line arguments for the cache configuration.
+ *
+ * Parameters:
+ *   sets - Reference to the number of sets in the cache
+ *   blocks - Reference to the number of blocks per set
+ *   size - Reference to the size of each block
+ *   miss - Reference to the string indicating the miss policy
+ *   write - Reference to the string indicating the write policy
+ *   eviction - Reference to the string indicating the eviction policy
+ *   argv - The array of command line arguments
+ *
+ * Returns:
+ *   True if the parameters are successfully parsed, False otherwise.
+ */
+bool parseInputParameters(int &sets, int &blocks, int &size, string &miss, string &write, string &eviction, char *argv[]) {
+    sets = std::atoi(argv[1]);
+    blocks = std::atoi(argv[2]);
+    size = std::atoi(argv[3]);
+    miss = argv[4];
+    write = argv[5];
+    eviction = argv[6];
+
+    // Validate block size
+    if (size < 4) {
+        cerr << "ERROR: Block size (" << size << ") is less than the minimum allowed size of 4 bytes." << endl;
+        return false;
+    }
+    if (!isPowerOfTwo(size)) {
+        cerr << "ERROR: Block size (" << size << ") is not a power of 2." << endl;
+        return false;
+    }
+
+    // Validate number of sets
+    if (!isPowerOfTwo(sets) || sets <= 0) {
+        cerr << "ERROR: Number of sets (" << sets << ") is not a positive power of 2." << endl;
+        return false;
+    }
+
+    // Validate that the index and offset fit in a 32-bit address
+    if ((uint64_t)sets * size > (1ULL << 32)) {
+        cerr << "ERROR: Number of sets (" << sets << ") times block size (" << size
+             << ") needs more than the 32 address bits." << endl;
+        return false;
+    }
+
+    // Validate number of blocks per set
+    if (blocks <= 0) {
+        cerr << "ERROR: Number of blocks per set (" << blocks << ") cannot be less than 1." << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Validates the command line arguments for the simulator.
+ *
+ * Parameters:
+ *   argc - The number of arguments passed to the program
+ *   argv - The array of arguments passed to the program
+ *
+ * Returns:
+ *   True if the arguments are valid, False otherwise.
+ */
+bool validateArguments(int argc, char *argv[]) {
+    if (argc < 7) {
+        cout << "Arguments provided: " << argc - 1 << endl;
+        cerr << "Usage: " << argv[0] << " <# of sets> <# of blocks> <block size> <write policy> <miss policy> <eviction policy>"
+             << " [--compact] [--tlb] [--tlb-l1 <entries>:<ways>] [--tlb-l2 <entries>:<ways>]"
+             << " [--huge-pages <bytes>] [--tenant <trace>]... [--schedule rr|timestamp|weighted:<w0>,...]"
+             << " [--partition <mask0>,...] [--sector-size <bytes>] [--miss-stream <file>]" << endl;
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
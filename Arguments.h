@@ -0,0 +1,45 @@
+/*
+ * Command line argument parsing for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Guards
+#ifndef ARGUMENTS_H
+#define ARGUMENTS_H
+
+// Libraries and Files
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Simulator.h"
+
+bool validateArguments(int argc, char *argv[]);
+bool parseInputParameters(int &sets, int &blocks, int &size, std::string &miss, std::string &write,
+                          std::string &eviction, char *argv[]);
+bool convertMissPolicy(const std::string &miss, WriteMissPolicy &missPolicy);
+bool convertWritePolicy(const std::string &write, const std::string &miss, WritePolicy &writePolicy);
+bool convertEvictionPolicy(const std::string &eviction, EvictionPolicy &evictionPolicy);
+bool parseOptions(int argc, char *argv[], SimOptions &options);
+bool parseTlbGeometry(const std::string &value, int &entries, int &ways, bool allowEmpty);
+std::vector<std::string> splitList(const std::string &value);
+bool parseSchedule(const std::string &value, SimOptions &options);
+bool validateTenants(int blocks, const SimOptions &options);
+bool isPowerOfTwo(int x);
+
+/*
+ * Builds a Simulator from the usual csim command line arguments
+ * (<# of sets> <# of blocks> <block size> <miss> <write> <eviction> [options]).
+ *
+ * Parameters:
+ *   argc - The number of command line arguments
+ *   argv - The array of command line arguments
+ *
+ * Returns:
+ *   The configured Simulator, or nullptr if any argument is invalid.
+ */
+std::unique_ptr<Simulator> buildSimulator(int argc, char *argv[]);
+
+#endif
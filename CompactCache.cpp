@@ -0,0 +1,320 @@
+/*
+ * Compact cache metadata implementations for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Libraries and Files
+#include "CompactCache.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+/*
+ * Constructor for the CompactCache class. Reserves the arena for every set.
+ * The mapping is anonymous, so untouched pages read back as zero (invalid
+ * slots) and are only backed by memory once written.
+ *
+ * Parameters:
+ *   sets - Number of sets in the cache
+ *   blocks - Number of blocks in each set
+ *   tagBits - Number of bits needed to hold a tag
+ *   sectors - Sectors per block, 0 when blocks are not sectored
+ *   ownerBits - Number of bits needed to hold a tenant, 0 outside tenant mode
+ */
+CompactCache::CompactCache(int sets, int blocks, int tagBits, int sectors, int ownerBits)
+    : blocks(blocks), tagBits(tagBits), rankBits(0), sectors(sectors), ownerBits(ownerBits), arena(nullptr),
+      touchedCount(0)
+{
+    // enough bits to rank every block in a set
+    while ((1 << rankBits) < blocks) {
+        rankBits++;
+    }
+    entryBits = 2 + rankBits + tagBits + 2 * sectors + ownerBits;
+
+    // one spare word so a field at the very end can straddle safely
+    uint64_t totalBits = (uint64_t)sets * blocks * entryBits;
+    uint64_t words = (totalBits + 63) / 64 + 1;
+    pageBytes = sysconf(_SC_PAGESIZE);
+    arenaBytes = ((words * 8 + pageBytes - 1) / pageBytes) * pageBytes;
+
+    void *mem = mmap(nullptr, arenaBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    arena = static_cast<uint64_t *>(mem);
+    touchedPages.resize(arenaBytes / pageBytes);
+}
+
+/*
+ * Copy constructor for the CompactCache class. Only pages that have been
+ * written are copied, so the copy stays as sparse as the original.
+ */
+CompactCache::CompactCache(const CompactCache &other)
+    : blocks(other.blocks), tagBits(other.tagBits), rankBits(other.rankBits), sectors(other.sectors),
+      ownerBits(other.ownerBits), entryBits(other.entryBits),
+      arena(nullptr), arenaBytes(other.arenaBytes), pageBytes(other.pageBytes), touchedPages(other.touchedPages),
+      touchedCount(other.touchedCount)
+{
+    void *mem = mmap(nullptr, arenaBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    arena = static_cast<uint64_t *>(mem);
+    for (size_t page = 0; page < touchedPages.size(); ++page) {
+        if (touchedPages[page]) {
+            memcpy((char *)arena + page * pageBytes, (const char *)other.arena + page * pageBytes, pageBytes);
+        }
+    }
+}
+
+/*
+ * Destructor for the CompactCache class. Releases the arena.
+ */
+CompactCache::~CompactCache()
+{
+    munmap(arena, arenaBytes);
+}
+
+/*
+ * Computes the bit offset of a slot within the arena.
+ */
+uint64_t CompactCache::entryOffset(int index, int block) const {
+    return ((uint64_t)index * blocks + block) * entryBits;
+}
+
+/*
+ * Reads a field of up to 32 bits starting at the given bit offset.
+ * A field may straddle two words.
+ */
+uint64_t CompactCache::getBits(uint64_t bit, int width) const {
+    if (width == 0) {
+        return 0;
+    }
+    uint64_t word = bit >> 6;
+    int shift = bit & 63;
+    uint64_t value = arena[word] >> shift;
+    if (shift + width > 64) {
+        value |= arena[word + 1] << (64 - shift);
+    }
+    return value & ((1ULL << width) - 1);
+}
+
+/*
+ * Writes a field of up to 32 bits starting at the given bit offset and
+ * records the pages it lands on as resident.
+ */
+void CompactCache::setBits(uint64_t bit, int width, uint64_t value) {
+    if (width == 0) {
+        return;
+    }
+    uint64_t word = bit >> 6;
+    int shift = bit & 63;
+    uint64_t mask = (1ULL << width) - 1;
+    value &= mask;
+    arena[word] = (arena[word] & ~(mask << shift)) | (value << shift);
+    uint64_t lastWord = word;
+    if (shift + width > 64) {
+        lastWord = word + 1;
+        arena[lastWord] = (arena[lastWord] & ~(mask >> (64 - shift))) | (value >> (64 - shift));
+    }
+    // record first touch of each page
+    for (uint64_t w = word; w <= lastWord; ++w) {
+        size_t page = (w * 8) / pageBytes;
+        if (!touchedPages[page]) {
+            touchedPages[page] = true;
+            touchedCount++;
+        }
+    }
+}
+
+/*
+ * Reads a field of up to 64 bits as 32-bit pieces.
+ */
+uint64_t CompactCache::getWide(uint64_t bit, int width) const {
+    uint64_t low = getBits(bit, std::min(width, 32));
+    return width > 32 ? low | getBits(bit + 32, width - 32) << 32 : low;
+}
+
+/*
+ * Writes a field of up to 64 bits as 32-bit pieces.
+ */
+void CompactCache::setWide(uint64_t bit, int width, uint64_t value) {
+    setBits(bit, std::min(width, 32), value);
+    if (width > 32) {
+        setBits(bit + 32, width - 32, value >> 32);
+    }
+}
+
+bool CompactCache::valid(int index, int block) const {
+    return getBits(entryOffset(index, block), 1);
+}
+
+bool CompactCache::dirty(int index, int block) const {
+    return getBits(entryOffset(index, block) + 1, 1);
+}
+
+uint32_t CompactCache::tag(int index, int block) const {
+    return getBits(entryOffset(index, block) + 2 + rankBits, tagBits);
+}
+
+int CompactCache::rank(int index, int block) const {
+    return getBits(entryOffset(index, block) + 2, rankBits);
+}
+
+/*
+ * Sector state of a slot, one bit per sector.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ */
+uint64_t CompactCache::sectorValid(int index, int block) const {
+    return getWide(entryOffset(index, block) + 2 + rankBits + tagBits, sectors);
+}
+
+uint64_t CompactCache::sectorDirty(int index, int block) const {
+    return getWide(entryOffset(index, block) + 2 + rankBits + tagBits + sectors, sectors);
+}
+
+/*
+ * Replaces a slot's sector state.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   valid - Sectors the slot holds
+ *   dirty - Sectors the slot has modified
+ */
+void CompactCache::setSectors(int index, int block, uint64_t valid, uint64_t dirty) {
+    uint64_t bit = entryOffset(index, block) + 2 + rankBits + tagBits;
+    setWide(bit, sectors, valid);
+    setWide(bit + sectors, sectors, dirty);
+}
+
+/*
+ * Tenant that filled a slot.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   tenant - The tenant to store
+ */
+int CompactCache::owner(int index, int block) const {
+    return getBits(entryOffset(index, block) + 2 + rankBits + tagBits + 2 * sectors, ownerBits);
+}
+
+void CompactCache::setOwner(int index, int block, int tenant) {
+    setBits(entryOffset(index, block) + 2 + rankBits + tagBits + 2 * sectors, ownerBits, tenant);
+}
+
+void CompactCache::setRank(int index, int block, int value) {
+    setBits(entryOffset(index, block) + 2, rankBits, value);
+}
+
+/*
+ * Makes a slot the newest in its set. Every valid slot that was newer than
+ * the slot's old position ages by one, which keeps ranks of valid slots
+ * distinct and in 0..blocks-1.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   from - The slot's old rank, or blocks if it was not in the order
+ */
+void CompactCache::promote(int index, int block, int from) {
+    for (int i = 0; i < blocks; ++i) {
+        if (i == block || !valid(index, i)) {
+            continue;
+        }
+        int curRank = rank(index, i);
+        if (curRank < from) {
+            setRank(index, i, curRank + 1);
+        }
+    }
+    setRank(index, block, 0);
+}
+
+/*
+ * Fills a slot with a new block and makes it the newest slot in its set.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   tag - The tag to store
+ *   dirty - Indicating if the block is dirty
+ */
+void CompactCache::fill(int index, int block, uint32_t tag, bool dirty) {
+    // a replaced slot leaves its old place in the order, an empty one had none
+    promote(index, block, valid(index, block) ? rank(index, block) : blocks);
+    uint64_t bit = entryOffset(index, block);
+    setBits(bit, 1, 1);
+    setBits(bit + 1, 1, dirty);
+    setBits(bit + 2 + rankBits, tagBits, tag);
+}
+
+/*
+ * Marks a slot as dirty.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ */
+void CompactCache::setDirty(int index, int block) {
+    setBits(entryOffset(index, block) + 1, 1, 1);
+}
+
+/*
+ * Moves a valid slot to the front of its set's replacement order.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ */
+void CompactCache::touch(int index, int block) {
+    promote(index, block, rank(index, block));
+}
+
+/*
+ * Finds the slot at the back of a set's replacement order.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   mask - Ways that may be chosen, one bit per way
+ *
+ * Returns:
+ *   The block number of the oldest allowed slot in the set.
+ */
+int CompactCache::oldest(int index, uint64_t mask) const {
+    int evictBlock = -1;
+    int maxRank = -1;
+    for (int i = 0; i < blocks; ++i) {
+        // ways past 64 are only reachable by an unpartitioned cache
+        if (i < 64 && !((mask >> i) & 1)) {
+            continue;
+        }
+        int curRank = rank(index, i);
+        if (curRank > maxRank) {
+            maxRank = curRank;
+            evictBlock = i;
+        }
+    }
+    return evictBlock;
+}
+
+int CompactCache::bitsPerBlock() const {
+    return entryBits;
+}
+
+size_t CompactCache::reservedBytes() const {
+    return arenaBytes;
+}
+
+size_t CompactCache::residentBytes() const {
+    return touchedCount * pageBytes;
+}
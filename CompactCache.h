@@ -0,0 +1,166 @@
+/*
+ * Compact cache metadata for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Guards
+#ifndef COMPACTCACHE_H
+#define COMPACTCACHE_H
+
+// Libraries and Files
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// Class Definition
+/*
+ * Bit-packed slot metadata stored in one contiguous arena.
+ * Each slot is laid out as [valid | dirty | rank | tag | sector valid |
+ * sector dirty | owner], where rank is the slot's replacement order within
+ * its set (0 = newest), the tag is only as wide as the address bits left
+ * after the index and offset, the sector fields hold one bit per sector
+ * (none when blocks are not sectored) and the owner is the tenant that
+ * filled the slot (no bits outside tenant mode). The arena is
+ * reserved up front but its pages are only backed by memory once a set on
+ * that page is first written, so sparse traces only pay for the sets they use.
+ */
+class CompactCache {
+ public:
+  /*
+ * Constructor for the CompactCache class. Reserves the arena for every set.
+ *
+ * Parameters:
+ *   sets - Number of sets in the cache
+ *   blocks - Number of blocks in each set
+ *   tagBits - Number of bits needed to hold a tag
+ *   sectors - Sectors per block, 0 when blocks are not sectored
+ *   ownerBits - Number of bits needed to hold a tenant, 0 outside tenant mode
+ */
+  CompactCache(int sets, int blocks, int tagBits, int sectors = 0, int ownerBits = 0);
+
+  /*
+ * Destructor for the CompactCache class. Releases the arena.
+ */
+  ~CompactCache();
+
+  /*
+ * Copy constructor for the CompactCache class. Only pages that have been
+ * written are copied, so the copy stays as sparse as the original.
+ */
+  CompactCache(const CompactCache &other);
+  CompactCache &operator=(const CompactCache &) = delete;
+
+  bool valid(int index, int block) const;
+  bool dirty(int index, int block) const;
+  uint32_t tag(int index, int block) const;
+
+/*
+ * Fills a slot with a new block and makes it the newest slot in its set.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   tag - The tag to store
+ *   dirty - Indicating if the block is dirty
+ */
+  void fill(int index, int block, uint32_t tag, bool dirty);
+
+/*
+ * Marks a slot as dirty.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ */
+  void setDirty(int index, int block);
+
+/*
+ * Sector state of a slot, one bit per sector.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ */
+  uint64_t sectorValid(int index, int block) const;
+  uint64_t sectorDirty(int index, int block) const;
+
+/*
+ * Replaces a slot's sector state.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   valid - Sectors the slot holds
+ *   dirty - Sectors the slot has modified
+ */
+  void setSectors(int index, int block, uint64_t valid, uint64_t dirty);
+
+/*
+ * Tenant that filled a slot.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   tenant - The tenant to store
+ */
+  int owner(int index, int block) const;
+  void setOwner(int index, int block, int tenant);
+
+/*
+ * Moves a valid slot to the front of its set's replacement order.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ */
+  void touch(int index, int block);
+
+/*
+ * Finds the slot at the back of a set's replacement order.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   mask - Ways that may be chosen, one bit per way
+ *
+ * Returns:
+ *   The block number of the oldest allowed slot in the set.
+ */
+  int oldest(int index, uint64_t mask = ~0ULL) const;
+
+  /* Footprint */
+  // bits of metadata per block
+  int bitsPerBlock() const;
+  // bytes reserved for the whole arena
+  size_t reservedBytes() const;
+  // bytes of arena pages that have been written at least once
+  size_t residentBytes() const;
+
+ private:
+  /* Variables */
+  int blocks;
+  int tagBits;
+  int rankBits;
+  int sectors;
+  int ownerBits;
+  int entryBits;
+  uint64_t *arena;
+  size_t arenaBytes;
+  size_t pageBytes;
+  std::vector<bool> touchedPages;
+  size_t touchedCount;
+
+  /* Methods */
+  uint64_t entryOffset(int index, int block) const;
+  uint64_t getBits(uint64_t bit, int width) const;
+  void setBits(uint64_t bit, int width, uint64_t value);
+  uint64_t getWide(uint64_t bit, int width) const;
+  void setWide(uint64_t bit, int width, uint64_t value);
+  int rank(int index, int block) const;
+  void setRank(int index, int block, int value);
+  void promote(int index, int block, int from);
+};
+
+#endif
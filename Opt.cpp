@@ -0,0 +1,159 @@
+/*
+ * Belady optimal replacement support implementations for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Libraries and Files
+#include "Opt.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+#include "Simulator.h"
+
+/*
+ * Constructor for the NextUseHeap class. Every set starts empty.
+ *
+ * Parameters:
+ *   sets - Number of sets in the cache
+ *   blocks - Number of blocks in each set
+ */
+NextUseHeap::NextUseHeap(int sets, int blocks) : blocks(blocks), heaps(sets) {}
+
+/*
+ * Finds a set's heap, allocating it the first time the set is filled.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *
+ * Returns:
+ *   Offset of the set's slots in the flat arrays.
+ */
+size_t NextUseHeap::claim(int index) {
+    if (heaps[index] == 0) {
+        heaps[index] = count.size() + 1;
+        count.push_back(0);
+        keys.resize(keys.size() + blocks);
+        heap.resize(heap.size() + blocks);
+        position.resize(position.size() + blocks, -1);
+    }
+    return (size_t)(heaps[index] - 1) * blocks;
+}
+
+void NextUseHeap::swapEntries(size_t base, int a, int b) {
+    std::swap(heap[base + a], heap[base + b]);
+    position[base + heap[base + a]] = a;
+    position[base + heap[base + b]] = b;
+}
+
+void NextUseHeap::siftUp(size_t base, int at) {
+    while (at > 0) {
+        int parent = (at - 1) / 2;
+        if (keys[base + heap[base + parent]] >= keys[base + heap[base + at]]) {
+            return;
+        }
+        swapEntries(base, parent, at);
+        at = parent;
+    }
+}
+
+void NextUseHeap::siftDown(size_t base, int at, int size) {
+    while (true) {
+        int largest = at;
+        int left = 2 * at + 1;
+        int right = left + 1;
+        if (left < size && keys[base + heap[base + left]] > keys[base + heap[base + largest]]) {
+            largest = left;
+        }
+        if (right < size && keys[base + heap[base + right]] > keys[base + heap[base + largest]]) {
+            largest = right;
+        }
+        if (largest == at) {
+            return;
+        }
+        swapEntries(base, at, largest);
+        at = largest;
+    }
+}
+
+/*
+ * Sets a block's next use, adding the block to its set's heap if needed.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   nextUse - Position of the block's next access, or NEVER_USED
+ */
+void NextUseHeap::update(int index, int block, uint64_t nextUse) {
+    size_t base = claim(index);
+    int &filled = count[heaps[index] - 1];
+    keys[base + block] = nextUse;
+    int at = position[base + block];
+    if (at < 0) {
+        at = filled++;
+        heap[base + at] = block;
+        position[base + block] = at;
+    }
+    siftUp(base, at);
+    siftDown(base, position[base + block], filled);
+}
+
+/*
+ * Finds the block in a set whose next use is furthest away.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *
+ * Returns:
+ *   The block number within the set.
+ */
+int NextUseHeap::furthest(int index) const {
+    return heap[(size_t)(heaps[index] - 1) * blocks];
+}
+
+/*
+ * Builds the next-use index for a decoded trace with a backward pass.
+ * Records are read in chunks from the end, so the trace itself never has to
+ * fit in memory, but the index of each block's latest access keeps one
+ * entry per distinct block: memory is O(distinct blocks) plus one chunk.
+ *
+ * Parameters:
+ *   trace - Temporary file of AccessRecords
+ *   records - Number of records in the trace
+ *   offsetBits - Block offset bits, so accesses are matched by block
+ *   nextUse - Temporary file that receives one uint64_t per record
+ *
+ * Returns:
+ *   True on success, False if a file could not be read or written.
+ */
+bool buildNextUse(FILE *trace, uint64_t records, int offsetBits, FILE *nextUse) {
+    std::unordered_map<uint32_t, uint64_t> lastSeen;
+    size_t buffered = std::min<uint64_t>(OPT_CHUNK, records);
+    std::vector<AccessRecord> chunk(buffered);
+    std::vector<uint64_t> next(buffered);
+    uint64_t end = records;
+    while (end > 0) {
+        uint64_t start = end > OPT_CHUNK ? end - OPT_CHUNK : 0;
+        size_t length = end - start;
+        if (fseeko(trace, start * sizeof(AccessRecord), SEEK_SET) != 0 ||
+            fread(chunk.data(), sizeof(AccessRecord), length, trace) != length) {
+            return false;
+        }
+        // walk backwards so lastSeen holds each block's next access
+        for (size_t i = length; i-- > 0;) {
+            uint32_t block = chunk[i].address >> offsetBits;
+            auto found = lastSeen.find(block);
+            next[i] = found == lastSeen.end() ? NEVER_USED : found->second;
+            lastSeen[block] = start + i;
+        }
+        if (fseeko(nextUse, start * sizeof(uint64_t), SEEK_SET) != 0 ||
+            fwrite(next.data(), sizeof(uint64_t), length, nextUse) != length) {
+            return false;
+        }
+        end = start;
+    }
+    return true;
+}
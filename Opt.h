@@ -0,0 +1,87 @@
+/*
+ * Belady optimal replacement support for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Guards
+#ifndef OPT_H
+#define OPT_H
+
+// Libraries and Files
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+// Next use of a block that is never accessed again
+static const uint64_t NEVER_USED = UINT64_MAX;
+
+// Records handled at a time by the offline passes
+static const size_t OPT_CHUNK = 1 << 20;
+
+// Class Definition
+/*
+ * Per-set indexed max-heaps of next-use positions, stored in flat arrays.
+ * The top of a set's heap is the block that is needed furthest in the future,
+ * and changing a block's next use costs O(log ways). A set's heap is only
+ * allocated when the set is first filled, so untouched sets cost 4 bytes.
+ */
+class NextUseHeap {
+ public:
+  NextUseHeap(int sets, int blocks);
+
+/*
+ * Sets a block's next use, adding the block to its set's heap if needed.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   nextUse - Position of the block's next access, or NEVER_USED
+ */
+  void update(int index, int block, uint64_t nextUse);
+
+/*
+ * Finds the block in a set whose next use is furthest away.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *
+ * Returns:
+ *   The block number within the set.
+ */
+  int furthest(int index) const;
+
+ private:
+  int blocks;
+  std::vector<uint32_t> heaps;  // per set, 1 + its heap's place below, 0 until first filled
+  std::vector<uint64_t> keys;   // next use per slot
+  std::vector<int> heap;        // per heap, block numbers in heap order
+  std::vector<int> position;    // per slot, place in its set's heap or -1
+  std::vector<int> count;       // per heap, blocks in the heap
+
+  size_t claim(int index);
+  void swapEntries(size_t base, int a, int b);
+  void siftUp(size_t base, int at);
+  void siftDown(size_t base, int at, int size);
+};
+
+/*
+ * Builds the next-use index for a decoded trace with a backward pass.
+ * Records are read in chunks from the end, so the trace itself never has to
+ * fit in memory, but the index of each block's latest access keeps one
+ * entry per distinct block: memory is O(distinct blocks) plus one chunk.
+ *
+ * Parameters:
+ *   trace - Temporary file of AccessRecords
+ *   records - Number of records in the trace
+ *   offsetBits - Block offset bits, so accesses are matched by block
+ *   nextUse - Temporary file that receives one uint64_t per record
+ *
+ * Returns:
+ *   True on success, False if a file could not be read or written.
+ */
+bool buildNextUse(FILE *trace, uint64_t records, int offsetBits, FILE *nextUse);
+
+#endif
@@ -0,0 +1,669 @@
+/*
+ * Simulation server implementations for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Libraries and Files
+#include "Server.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "Arguments.h"
+#include "Trace.h"
+
+// Statements
+using std::cerr;
+using std::cin;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+// Largest payload accepted in one request (2M access records)
+static const uint32_t MAX_PAYLOAD = 16 * 1024 * 1024;
+// Records the client sends per access request
+static const size_t CLIENT_BATCH = 65536;
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int) {
+    stopRequested = 1;
+}
+
+/*
+ * Fills in a sockaddr_un for the given path.
+ *
+ * Returns:
+ *   False if the path is too long for a Unix domain socket.
+ */
+static bool socketAddress(const string &path, sockaddr_un &addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        cerr << "ERROR: Socket path is too long: " << path << endl;
+        return false;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+/*
+ * Checks whether a path may be taken over for a new socket. Nothing there is
+ * fine, and so is a stale socket no server is listening on, which is removed.
+ * Any other file, or a socket that still accepts connections, is left alone.
+ *
+ * Parameters:
+ *   path - Filesystem path of the Unix domain socket
+ *   addr - The socket address for that path
+ *
+ * Returns:
+ *   True if the path is free to bind, False otherwise.
+ */
+static bool claimSocketPath(const string &path, const sockaddr_un &addr) {
+    struct stat info;
+    if (lstat(path.c_str(), &info) < 0) {
+        if (errno == ENOENT) {
+            return true;
+        }
+        perror("lstat");
+        return false;
+    }
+    if (!S_ISSOCK(info.st_mode)) {
+        cerr << path << " exists and is not a socket" << endl;
+        return false;
+    }
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) {
+        perror("socket");
+        return false;
+    }
+    bool live = connect(probe, (const sockaddr *)&addr, sizeof(addr)) == 0;
+    close(probe);
+    if (live) {
+        cerr << "A server is already listening on " << path << endl;
+        return false;
+    }
+    unlink(path.c_str());
+    return true;
+}
+
+/*
+ * Constructor for the Server class. Binds and listens on the socket path,
+ * replacing any stale socket left behind by an earlier server.
+ *
+ * Parameters:
+ *   path - Filesystem path of the Unix domain socket
+ */
+Server::Server(const string &path) : path(path), listenFd(-1), epollFd(-1)
+{
+    sockaddr_un addr;
+    if (!socketAddress(path, addr)) {
+        return;
+    }
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        perror("socket");
+        return;
+    }
+    if (!claimSocketPath(path, addr)) {
+        close(listenFd);
+        listenFd = -1;
+        return;
+    }
+    if (bind(listenFd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listenFd, SOMAXCONN) < 0) {
+        perror("bind");
+        close(listenFd);
+        listenFd = -1;
+        return;
+    }
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+}
+
+/*
+ * Destructor for the Server class. Closes every connection and removes the socket.
+ */
+Server::~Server()
+{
+    while (!connections.empty()) {
+        closeClient(connections.begin()->first);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(path.c_str());
+    }
+}
+
+/*
+ * Runs the event loop until the process receives SIGINT or SIGTERM.
+ *
+ * Returns:
+ *   0 on a clean shutdown, 1 if the socket could not be set up or polled.
+ */
+int Server::run() {
+    if (listenFd < 0 || epollFd < 0) {
+        return 1;
+    }
+    // no SA_RESTART so a signal wakes epoll_wait
+    struct sigaction action = {};
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    const int maxEvents = 64;
+    epoll_event events[maxEvents];
+    while (!stopRequested) {
+        int ready = epoll_wait(epollFd, events, maxEvents, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            return 1;
+        }
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+            // a client can be closed by an earlier event in this batch
+            if (connections.count(fd) == 0) {
+                continue;
+            }
+            bool open = true;
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                open = readClient(fd);
+            }
+            if (open && (events[i].events & EPOLLOUT)) {
+                open = flushClient(fd);
+            }
+            if (!open) {
+                closeClient(fd);
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Accepts every pending client and registers it with the event loop.
+ */
+void Server::acceptClients() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        connections[fd];
+    }
+}
+
+/*
+ * Reads everything available from a client, handles each complete request
+ * and sends back whatever responses it can without blocking.
+ *
+ * Parameters:
+ *   fd - The client's socket
+ *
+ * Returns:
+ *   False if the client hung up or broke the protocol.
+ */
+bool Server::readClient(int fd) {
+    Connection &conn = connections[fd];
+    bool open = true;
+    char buffer[65536];
+    while (true) {
+        ssize_t got = recv(fd, buffer, sizeof(buffer), 0);
+        if (got > 0) {
+            conn.in.append(buffer, got);
+            continue;
+        }
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        // hung up, but still answer anything that fully arrived
+        open = false;
+        break;
+    }
+
+    // handle every complete request in the buffer
+    while (conn.in.size() - conn.inPos >= sizeof(RequestHeader)) {
+        RequestHeader header;
+        memcpy(&header, conn.in.data() + conn.inPos, sizeof(header));
+        if (header.payloadLength > MAX_PAYLOAD) {
+            return false;
+        }
+        size_t frame = sizeof(header) + header.nameLength + header.payloadLength;
+        if (conn.in.size() - conn.inPos < frame) {
+            break;
+        }
+        const char *name = conn.in.data() + conn.inPos + sizeof(header);
+        handle(conn, header.command, string(name, header.nameLength), name + header.nameLength,
+               header.payloadLength);
+        conn.inPos += frame;
+    }
+    // drop consumed bytes without moving them on every request
+    if (conn.inPos == conn.in.size()) {
+        conn.in.clear();
+        conn.inPos = 0;
+    }
+    else if (conn.inPos > MAX_PAYLOAD) {
+        conn.in.erase(0, conn.inPos);
+        conn.inPos = 0;
+    }
+    return flushClient(fd) && open;
+}
+
+/*
+ * Sends as much queued output as the socket accepts, and only asks the event
+ * loop for writability while output is still pending.
+ *
+ * Parameters:
+ *   fd - The client's socket
+ *
+ * Returns:
+ *   False if the client can no longer be written to.
+ */
+bool Server::flushClient(int fd) {
+    Connection &conn = connections[fd];
+    while (conn.outPos < conn.out.size()) {
+        ssize_t sent = send(fd, conn.out.data() + conn.outPos, conn.out.size() - conn.outPos, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return false;
+        }
+        conn.outPos += sent;
+    }
+    bool pending = conn.outPos < conn.out.size();
+    if (!pending) {
+        conn.out.clear();
+        conn.outPos = 0;
+    }
+    if (pending != conn.writing) {
+        conn.writing = pending;
+        epoll_event event = {};
+        event.events = pending ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+    }
+    return true;
+}
+
+/*
+ * Unregisters and closes a client.
+ *
+ * Parameters:
+ *   fd - The client's socket
+ */
+void Server::closeClient(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
+
+/*
+ * Queues a response on a connection.
+ *
+ * Parameters:
+ *   conn - The connection to respond on
+ *   status - Whether the request succeeded
+ *   payload - The response payload
+ */
+void Server::respond(Connection &conn, Status status, const string &payload) {
+    ResponseHeader header = {};
+    header.status = static_cast<uint8_t>(status);
+    header.payloadLength = payload.size();
+    conn.out.append((const char *)&header, sizeof(header));
+    conn.out.append(payload);
+}
+
+/*
+ * Builds a Simulator from csim arguments, as if they had been given on the
+ * command line. What the argument checks would print is captured instead,
+ * so it can be sent back to the client rather than the server's terminal.
+ *
+ * Parameters:
+ *   config - The arguments after the program name
+ *   error - Set to the reason the arguments were rejected
+ *
+ * Returns:
+ *   The configured Simulator, or nullptr if the arguments are invalid.
+ */
+std::unique_ptr<Simulator> Server::build(const vector<string> &config, string &error) {
+    vector<char *> argv;
+    argv.push_back(const_cast<char *>("csim"));
+    for (const string &arg : config) {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    std::ostringstream messages;
+    std::streambuf *previousErr = cerr.rdbuf(messages.rdbuf());
+    std::streambuf *previousOut = cout.rdbuf(messages.rdbuf());
+    std::unique_ptr<Simulator> sim;
+    try {
+        sim = buildSimulator(argv.size() - 1, argv.data());
+    }
+    catch (...) {
+        cerr.rdbuf(previousErr);
+        cout.rdbuf(previousOut);
+        throw;
+    }
+    cerr.rdbuf(previousErr);
+    cout.rdbuf(previousOut);
+    error = messages.str();
+    // the client adds its own prefix and line end
+    if (error.compare(0, 7, "ERROR: ") == 0) {
+        error.erase(0, 7);
+    }
+    while (!error.empty() && error.back() == '\n') {
+        error.pop_back();
+    }
+    return sim;
+}
+
+/*
+ * Handles one complete request and queues its response.
+ *
+ * Parameters:
+ *   conn - The connection the request arrived on
+ *   command - The request's command
+ *   name - The instance the request targets
+ *   payload - The request's payload
+ *   length - Size of the payload in bytes
+ */
+void Server::handle(Connection &conn, uint8_t command, const string &name, const char *payload, uint32_t length) {
+    if (static_cast<Command>(command) == Command::Create) {
+        if (instances.count(name)) {
+            respond(conn, Status::Error, "instance already exists: " + name);
+            return;
+        }
+        Instance instance;
+        std::istringstream iss(string(payload, length));
+        string arg;
+        while (iss >> arg) {
+            instance.config.push_back(arg);
+        }
+        string error;
+        instance.sim = build(instance.config, error);
+        if (!instance.sim) {
+            respond(conn, Status::Error, "invalid configuration: " + (error.empty() ? string(payload, length) : error));
+            return;
+        }
+        if (instance.sim->needsOwnInput()) {
+            respond(conn, Status::Error, "opt eviction and tenant traces read their own input and cannot be served");
+            return;
+        }
+        if (instance.sim->exportsMisses()) {
+            respond(conn, Status::Error, "miss streams are only written by command-line runs");
+            return;
+        }
+        instances[name] = std::move(instance);
+        respond(conn, Status::Ok, "");
+        return;
+    }
+
+    auto found = instances.find(name);
+    if (found == instances.end()) {
+        respond(conn, Status::Error, "no such instance: " + name);
+        return;
+    }
+    Instance &instance = found->second;
+
+    switch (static_cast<Command>(command)) {
+    case Command::Access: {
+        if (length % sizeof(AccessRecord) != 0) {
+            respond(conn, Status::Error, "access payload is not a whole number of records");
+            return;
+        }
+        size_t count = length / sizeof(AccessRecord);
+        for (size_t i = 0; i < count; ++i) {
+            AccessRecord record;
+            memcpy(&record, payload + i * sizeof(record), sizeof(record));
+            if (instance.sim->access(record.type, record.address, record.size) == 1) {
+                respond(conn, Status::Error, "invalid type in record " + std::to_string(i));
+                return;
+            }
+        }
+        respond(conn, Status::Ok, "");
+        break;
+    }
+    case Command::Stats: {
+        std::ostringstream out;
+        instance.sim->print(out);
+        respond(conn, Status::Ok, out.str());
+        break;
+    }
+    case Command::Reset: {
+        // the configuration was accepted when the instance was created
+        string error;
+        instance.sim = build(instance.config, error);
+        respond(conn, Status::Ok, "");
+        break;
+    }
+    case Command::Snapshot: {
+        string copyName(payload, length);
+        if (instances.count(copyName)) {
+            respond(conn, Status::Error, "instance already exists: " + copyName);
+            return;
+        }
+        Instance copy;
+        copy.config = instance.config;
+        copy.sim.reset(new Simulator(*instance.sim));
+        instances[copyName] = std::move(copy);
+        respond(conn, Status::Ok, "");
+        break;
+    }
+    case Command::Delete:
+        instances.erase(found);
+        respond(conn, Status::Ok, "");
+        break;
+    default:
+        respond(conn, Status::Error, "unknown command " + std::to_string(command));
+        break;
+    }
+}
+
+/*
+ * Entry point for `csim --server <socket path>`.
+ */
+int runServer(int argc, char *argv[]) {
+    if (argc != 3) {
+        cerr << "Usage: " << argv[0] << " --server <socket path>" << endl;
+        return 1;
+    }
+    Server server(argv[2]);
+    return server.run();
+}
+
+/*
+ * Writes a whole buffer to a blocking socket.
+ */
+static bool sendAll(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+/*
+ * Reads exactly length bytes from a blocking socket.
+ */
+static bool recvAll(int fd, char *data, size_t length) {
+    while (length > 0) {
+        ssize_t got = recv(fd, data, length, 0);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        data += got;
+        length -= got;
+    }
+    return true;
+}
+
+/*
+ * Sends one request and waits for its response.
+ *
+ * Parameters:
+ *   fd - The connected socket
+ *   command - The request's command
+ *   name - The instance the request targets
+ *   payload - The request's payload
+ *   length - Size of the payload in bytes
+ *   reply - Set to the response payload
+ *
+ * Returns:
+ *   True if the server answered with Ok.
+ */
+static bool request(int fd, Command command, const string &name, const char *payload, size_t length, string &reply) {
+    RequestHeader header = {};
+    header.command = static_cast<uint8_t>(command);
+    header.nameLength = name.size();
+    header.payloadLength = length;
+    if (!sendAll(fd, (const char *)&header, sizeof(header)) || !sendAll(fd, name.data(), name.size()) ||
+        !sendAll(fd, payload, length)) {
+        reply = "lost connection to server";
+        return false;
+    }
+    ResponseHeader response;
+    if (!recvAll(fd, (char *)&response, sizeof(response))) {
+        reply = "lost connection to server";
+        return false;
+    }
+    reply.resize(response.payloadLength);
+    if (!recvAll(fd, &reply[0], reply.size())) {
+        reply = "lost connection to server";
+        return false;
+    }
+    return static_cast<Status>(response.status) == Status::Ok;
+}
+
+/*
+ * Entry point for `csim --client <socket path> <command> <name> [args]`.
+ * The access command reads a text trace from standard input and streams it
+ * to the server in binary batches.
+ */
+int runClient(int argc, char *argv[]) {
+    if (argc < 5) {
+        cerr << "Usage: " << argv[0]
+             << " --client <socket path> <create|access|stats|reset|snapshot|delete> <name> [args]" << endl;
+        return 1;
+    }
+    string command = argv[3];
+    string name = argv[4];
+    if (name.size() > 255) {
+        cerr << "ERROR: Instance name is longer than 255 bytes." << endl;
+        return 1;
+    }
+    sockaddr_un addr;
+    if (!socketAddress(argv[2], addr)) {
+        return 1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("connect");
+        return 1;
+    }
+
+    bool ok = true;
+    string reply;
+    if (command == "create") {
+        string config;
+        for (int i = 5; i < argc; ++i) {
+            config += (i > 5 ? " " : "") + string(argv[i]);
+        }
+        ok = request(fd, Command::Create, name, config.data(), config.size(), reply);
+    }
+    else if (command == "access") {
+        vector<AccessRecord> batch;
+        batch.reserve(CLIENT_BATCH);
+        TraceReader reader(cin);
+        AccessRecord record;
+        uint64_t sequence;
+        int status = 0;
+        while (ok && (status = reader.next(record, sequence)) == 1) {
+            batch.push_back(record);
+            if (batch.size() == CLIENT_BATCH) {
+                ok = request(fd, Command::Access, name, (const char *)batch.data(),
+                             batch.size() * sizeof(AccessRecord), reply);
+                batch.clear();
+            }
+        }
+        if (status < 0) {
+            cerr << reader.error() << endl;
+            close(fd);
+            return 1;
+        }
+        if (ok && !batch.empty()) {
+            ok = request(fd, Command::Access, name, (const char *)batch.data(), batch.size() * sizeof(AccessRecord),
+                         reply);
+        }
+    }
+    else if (command == "stats") {
+        ok = request(fd, Command::Stats, name, nullptr, 0, reply);
+        if (ok) {
+            cout << reply;
+        }
+    }
+    else if (command == "reset") {
+        ok = request(fd, Command::Reset, name, nullptr, 0, reply);
+    }
+    else if (command == "snapshot" && argc == 6) {
+        string copyName = argv[5];
+        ok = request(fd, Command::Snapshot, name, copyName.data(), copyName.size(), reply);
+    }
+    else if (command == "delete") {
+        ok = request(fd, Command::Delete, name, nullptr, 0, reply);
+    }
+    else {
+        cerr << "ERROR: Unknown client command " << command << endl;
+        ok = false;
+    }
+    close(fd);
+    if (!ok && !reply.empty()) {
+        cerr << "ERROR: " << reply << endl;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+/*
+ * Simulation server for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Guards
+#ifndef SERVER_H
+#define SERVER_H
+
+// Libraries and Files
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Simulator.h"
+
+/*
+ * Protocol
+ * Clients talk to the server over a Unix domain stream socket. Every request
+ * is a RequestHeader followed by the instance name and then the payload;
+ * every request gets exactly one ResponseHeader followed by its payload, in
+ * order. All integers are in host byte order since both ends share a machine.
+ *
+ *   Create   payload: csim arguments, e.g. "256 4 16 write-allocate write-back lru"
+ *   Access   payload: packed AccessRecords (see Simulator.h), simulated in order
+ *   Stats    response payload: the same text csim prints at the end of a run
+ *   Reset    clears the cache and statistics back to a fresh instance
+ *   Snapshot payload: name of a new instance that starts as a copy of this one
+ *   Delete   removes the instance
+ *
+ * On failure the response status is Error and the payload is a message.
+ */
+enum class Command : uint8_t { Create = 1, Access = 2, Stats = 3, Reset = 4, Snapshot = 5, Delete = 6 };
+enum class Status : uint8_t { Ok = 0, Error = 1 };
+
+struct RequestHeader {
+  uint8_t command;
+  uint8_t nameLength;
+  uint16_t reserved;
+  uint32_t payloadLength;
+};
+
+struct ResponseHeader {
+  uint8_t status;
+  uint8_t reserved[3];
+  uint32_t payloadLength;
+};
+
+static_assert(sizeof(RequestHeader) == 8, "RequestHeader must be packed");
+static_assert(sizeof(ResponseHeader) == 8, "ResponseHeader must be packed");
+
+// Class Definition
+class Server {
+ public:
+  /*
+ * Constructor for the Server class. Binds and listens on the socket path,
+ * replacing any stale socket left behind by an earlier server.
+ *
+ * Parameters:
+ *   path - Filesystem path of the Unix domain socket
+ */
+  Server(const std::string &path);
+
+  /*
+ * Destructor for the Server class. Closes every connection and removes the socket.
+ */
+  ~Server();
+
+  Server(const Server &) = delete;
+  Server &operator=(const Server &) = delete;
+
+/*
+ * Runs the event loop until the process receives SIGINT or SIGTERM.
+ *
+ * Returns:
+ *   0 on a clean shutdown, 1 if the socket could not be set up or polled.
+ */
+  int run();
+
+ private:
+  /* Types */
+  struct Instance {
+    std::vector<std::string> config;
+    std::unique_ptr<Simulator> sim;
+  };
+  struct Connection {
+    std::string in;
+    size_t inPos = 0;
+    std::string out;
+    size_t outPos = 0;
+    bool writing = false;  // registered for EPOLLOUT
+  };
+
+  /* Variables */
+  std::string path;
+  int listenFd;
+  int epollFd;
+  std::map<std::string, Instance> instances;
+  std::map<int, Connection> connections;
+
+  /* Methods */
+  void acceptClients();
+  bool readClient(int fd);
+  bool flushClient(int fd);
+  void closeClient(int fd);
+
+/*
+ * Handles one complete request and queues its response.
+ *
+ * Parameters:
+ *   conn - The connection the request arrived on
+ *   command - The request's command
+ *   name - The instance the request targets
+ *   payload - The request's payload
+ *   length - Size of the payload in bytes
+ */
+  void handle(Connection &conn, uint8_t command, const std::string &name, const char *payload, uint32_t length);
+  void respond(Connection &conn, Status status, const std::string &payload);
+  std::unique_ptr<Simulator> build(const std::vector<std::string> &config, std::string &error);
+};
+
+/*
+ * Entry point for `csim --server <socket path>`.
+ */
+int runServer(int argc, char *argv[]);
+
+/*
+ * Entry point for `csim --client <socket path> <command> <name> [args]`.
+ * The access command reads a text trace from standard input and streams it
+ * to the server in binary batches.
+ */
+int runClient(int argc, char *argv[]);
+
+#endif
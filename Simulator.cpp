@@ -15,6 +15,9 @@
 #include <sstream>
 #include <stdexcept>
 
+#include "Tenants.h"
+#include "Trace.h"
+
 // Statements
 using std::bitset;
 using std::cerr;
@@ -26,6 +29,9 @@ using std::ifstream;
 using std::string;
 using std::vector;
 
+// An L2 TLB hit costs a few cycles on top of the cache access
+static const int TLB_L2_HIT_CYCLES = 7;
+
 /*
  * Constructor for the Simulator class. Initializes a cache simulation instance
  * with the given configurations for sets, blocks per set, block size,
@@ -37,22 +43,63 @@ using std::vector;
  *   size - Size of each block in bytes
  *   miss - Policy for handling write misses (No-write allocate / Write-allocate)
  *   write - Policy for write operations (Write-through / Write-back)
- *   eviction - Policy for eviction (LRU / FIFO)
+ *   eviction - Policy for eviction (LRU / FIFO / OPT)
+ *   options - Optional features to enable
  */
-Simulator::Simulator(int sets, int blocks, int size, WriteMissPolicy miss, WritePolicy write, EvictionPolicy eviction)
+Simulator::Simulator(int sets, int blocks, int size, WriteMissPolicy miss, WritePolicy write, EvictionPolicy eviction,
+                     const SimOptions &options)
     : sets(sets), blocks(blocks), size(size), missPolicy(miss), writePolicy(write), evictionPolicy(eviction), loads(0),
-      stores(0), lhits(0), lmisses(0), shits(0), smisses(0), cycles(0)
+      stores(0), lhits(0), lmisses(0), shits(0), smisses(0), cycles(0), ticks(0), tlbL1Hits(0), tlbL1Misses(0),
+      tlbL2Hits(0), tlbL2Misses(0), walkHits(0), walkMisses(0), walkCycles(0), currentNextUse(NEVER_USED),
+      sectorBytes(size), accessBytes(4), currentSectors(1), sectorMisses(0), bytesRead(0), bytesWritten(0),
+      currentSequence(0), currentBlock(0), options(options), currentTenant(-1)
 {
     
     // Initialize Cache
-    cache.sets.resize(sets);
-    for (int i = 0; i < sets; ++i)
-    {
-        cache.sets[i].slots.resize(blocks);
+    int sectors = options.sectorSize > 0 ? size / options.sectorSize : 0;
+    if (options.compact) {
+        // sets are only backed by memory once they are first written
+        int tagBits = 32 - (int)log2(size) - (int)log2(sets);
+        // tenants share the cache, so each slot also remembers whose block it holds
+        int ownerBits = 0;
+        while ((size_t)1 << ownerBits < options.tenantTraces.size()) {
+            ownerBits++;
+        }
+        compactCache.emplace(sets, blocks, tagBits, sectors, ownerBits);
+    }
+    else {
+        cache.sets.resize(sets);
+        for (int i = 0; i < sets; ++i)
+        {
+            cache.sets[i].slots.resize(blocks);
+        }
     }
 
     
-    memoryMultiplier = size / 4;
+    if (sectors > 0) {
+        sectorBytes = options.sectorSize;
+        // the compact layout keeps sector bits in its own entries
+        if (!compactCache) {
+            sectorValid.assign((size_t)sets * blocks, 0);
+            sectorDirty.assign((size_t)sets * blocks, 0);
+        }
+    }
+    // memory transfers move one sector (the whole block unless sectored) at a time
+    memoryMultiplier = sectorBytes / 4;
+
+    if (options.tlb) {
+        tlb.emplace(options.tlbConfig);
+    }
+    if (eviction == EvictionPolicy::OPT) {
+        nextUses.emplace(sets, blocks);
+    }
+    if (!options.tenantTraces.empty()) {
+        tenantStats.resize(options.tenantTraces.size());
+        // the compact layout keeps owners in its own entries
+        if (!compactCache) {
+            owners.assign((size_t)sets * blocks, -1);
+        }
+    }
 }
 
 /*
@@ -72,33 +119,327 @@ Simulator::~Simulator()
  *   0 on successful simulation, 1 on encountering invalid input operations.
  */
 int Simulator::simulate() {
+    if (!options.missStream.empty()) {
+        missStream = std::make_shared<MissStreamWriter>(options.missStream, log2(size));
+        if (!missStream->isOpen()) {
+            cerr << "Could not open miss stream " << options.missStream << endl;
+            return 1;
+        }
+    }
+    int status;
+    if (evictionPolicy == EvictionPolicy::OPT) {
+        status = simulateOffline();
+    }
+    else if (!options.tenantTraces.empty()) {
+        status = simulateTenants();
+    }
+    else {
+        status = simulateTrace();
+    }
+    if (missStream && !missStream->close()) {
+        cerr << "Could not write miss stream " << options.missStream << endl;
+        status = 1;
+    }
+    return status;
+}
+
+/*
+ * Simulates the accesses on standard input, which may be a text trace or a
+ * miss stream written by another run.
+ *
+ * Returns:
+ *   0 on successful simulation, 1 on encountering invalid input.
+ */
+int Simulator::simulateTrace() {
     // Read from file from stdin
-    string line;
-    while (getline(cin, line)) {
-        /* Reading Line */
-        // Variables for reading line
-        std::istringstream iss(line);
-        string type;
-        string address;
-        // Parse line
-        iss >> type >> address;
-        if (type == "l") {
-            // writes to loads/stores to/from memory take 100 cycles
-            load(address);
-            loads++;
+    TraceReader reader(cin);
+    AccessRecord record;
+    int status;
+    while ((status = reader.next(record, currentSequence)) == 1) {
+        access(record.type, toBinary(record.address), record.size);
+    }
+    if (status < 0) {
+        cerr << reader.error() << endl;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Simulates the cache with optimal (Belady) replacement. The trace is decoded
+ * to a temporary file, a backward pass records each access's next use of the
+ * same block, and a forward pass replays the trace with those next uses.
+ * Every pass works a chunk at a time, so memory does not grow with the
+ * length of the trace.
+ *
+ * Returns:
+ *   0 on successful simulation, 1 on invalid input or a temporary file error.
+ */
+/*
+ * Appends a decoded chunk to the opt temporary files.
+ *
+ * Parameters:
+ *   chunk - The decoded accesses
+ *   order - Their original sequence numbers, only written with a sequences file
+ *   trace - Temporary file of AccessRecords
+ *   sequences - Temporary file of sequence numbers, or nullptr
+ *
+ * Returns:
+ *   True if every record was written, False otherwise.
+ */
+static bool writeChunk(const vector<AccessRecord> &chunk, const vector<uint64_t> &order, FILE *trace,
+                       FILE *sequences) {
+    if (fwrite(chunk.data(), sizeof(AccessRecord), chunk.size(), trace) != chunk.size() ||
+        (sequences != nullptr && fwrite(order.data(), sizeof(uint64_t), order.size(), sequences) != order.size())) {
+        cerr << "Could not write the trace for opt" << endl;
+        return false;
+    }
+    return true;
+}
+
+int Simulator::simulateOffline() {
+    FILE *trace = tmpfile();
+    FILE *nextUse = tmpfile();
+    // original sequence numbers are only kept when a miss stream needs them
+    FILE *sequences = missStream ? tmpfile() : nullptr;
+    if (trace == nullptr || nextUse == nullptr || (missStream && sequences == nullptr)) {
+        cerr << "Could not create temporary files for opt" << endl;
+        for (FILE *file : {trace, nextUse, sequences}) {
+            if (file != nullptr) {
+                fclose(file);
+            }
         }
-        else if (type == "s") {
-            store(address);
-            stores++;
+        return 1;
+    }
+    int status = 0;
+    // Decode the trace
+    TraceReader reader(cin);
+    vector<AccessRecord> chunk;
+    vector<uint64_t> order;
+    uint64_t records = 0;
+    AccessRecord record;
+    uint64_t sequence;
+    int read = 0;
+    while (status == 0 && (read = reader.next(record, sequence)) == 1) {
+        record.address = toBinary(record.address);
+        chunk.push_back(record);
+        if (sequences != nullptr) {
+            order.push_back(sequence);
         }
-        else {
-            cerr << "Invalid type" << endl;
-            return 1;
+        if (chunk.size() == OPT_CHUNK) {
+            if (!writeChunk(chunk, order, trace, sequences)) {
+                status = 1;
+            }
+            records += chunk.size();
+            chunk.clear();
+            order.clear();
         }
     }
+    if (read < 0) {
+        cerr << reader.error() << endl;
+        status = 1;
+    }
+    if (status == 0 && !writeChunk(chunk, order, trace, sequences)) {
+        status = 1;
+    }
+    records += chunk.size();
+    if (sequences != nullptr) {
+        rewind(sequences);
+    }
+    // buffers only need to hold one chunk, or the whole trace if it is shorter
+    size_t buffered = std::min<uint64_t>(OPT_CHUNK, records);
+    if (sequences != nullptr) {
+        order.resize(buffered);
+    }
+    if (status == 0 && !buildNextUse(trace, records, log2(size), nextUse)) {
+        cerr << "Could not build the next-use index for opt" << endl;
+        status = 1;
+    }
+    // Replay the trace in order
+    vector<uint64_t> next(buffered);
+    chunk.resize(buffered);
+    rewind(trace);
+    rewind(nextUse);
+    for (uint64_t done = 0; status == 0 && done < records;) {
+        size_t length = std::min<uint64_t>(OPT_CHUNK, records - done);
+        if (fread(chunk.data(), sizeof(AccessRecord), length, trace) != length ||
+            fread(next.data(), sizeof(uint64_t), length, nextUse) != length ||
+            (sequences != nullptr && fread(order.data(), sizeof(uint64_t), length, sequences) != length)) {
+            cerr << "Could not read back the trace for opt" << endl;
+            status = 1;
+            break;
+        }
+        for (size_t i = 0; i < length; ++i) {
+            currentNextUse = next[i];
+            currentSequence = sequences != nullptr ? order[i] : done + i;
+            access(chunk[i].type, chunk[i].address, chunk[i].size);
+        }
+        done += length;
+    }
+    fclose(trace);
+    fclose(nextUse);
+    if (sequences != nullptr) {
+        fclose(sequences);
+    }
+    return status;
+}
+
+/*
+ * Simulates several tenants sharing the cache. Their traces are interleaved
+ * by the configured schedule and every access is charged to its tenant.
+ *
+ * Returns:
+ *   0 on successful simulation, 1 on an unreadable trace or invalid input.
+ */
+int Simulator::simulateTenants() {
+    TenantMerger merger(options.tenantTraces, options.schedule, options.tenantWeights);
+    string missing = merger.unopened();
+    if (!missing.empty()) {
+        cerr << "Could not open trace " << missing << endl;
+        return 1;
+    }
+    int tenant;
+    AccessRecord record;
+    int status;
+    while ((status = merger.next(tenant, record)) == 1) {
+        // charge whatever this access changes to its tenant
+        int lhitsBefore = lhits, lmissesBefore = lmisses, shitsBefore = shits, smissesBefore = smisses;
+        uint64_t cyclesBefore = cycles;
+        currentTenant = tenant;
+        access(record.type, record.address, record.size);
+        TenantStats &stats = tenantStats[tenant];
+        stats.loads += record.type == 'l';
+        stats.stores += record.type == 's';
+        stats.lhits += lhits - lhitsBefore;
+        stats.lmisses += lmisses - lmissesBefore;
+        stats.shits += shits - shitsBefore;
+        stats.smisses += smisses - smissesBefore;
+        stats.cycles += cycles - cyclesBefore;
+        for (TenantStats &each : tenantStats) {
+            each.occupancySum += each.occupancy;
+        }
+        currentSequence++; // miss streams number records by their place in the interleaving
+    }
+    currentTenant = -1;
+    if (status < 0) {
+        cerr << merger.error() << endl;
+        return 1;
+    }
     return 0;
 }
 
+/*
+ * Checks whether the current tenant may fill a way under way partitioning.
+ *
+ * Parameters:
+ *   block - Block number within a set
+ *
+ * Returns:
+ *   True if the way is in the tenant's mask or the cache is unpartitioned.
+ */
+bool Simulator::wayAllowed(int block) const {
+    if (options.wayMasks.empty() || currentTenant < 0) {
+        return true;
+    }
+    return block < 64 && ((options.wayMasks[currentTenant] >> block) & 1);
+}
+
+/*
+ * Builds the current tenant's way mask for the compact layout.
+ */
+uint64_t Simulator::allowedWays() const {
+    if (options.wayMasks.empty() || currentTenant < 0) {
+        return ~0ULL;
+    }
+    return options.wayMasks[currentTenant];
+}
+
+/*
+ * Reports whether the simulation has to read its own input: opt needs the
+ * whole trace up front, and tenant mode reads its own trace files. Such a
+ * simulator cannot be fed one access at a time through access().
+ */
+bool Simulator::needsOwnInput() const {
+    return evictionPolicy == EvictionPolicy::OPT || !options.tenantTraces.empty();
+}
+
+/*
+ * Reports whether the simulation writes a miss stream, which only happens
+ * while simulate() runs.
+ */
+bool Simulator::exportsMisses() const {
+    return !options.missStream.empty();
+}
+
+/*
+ * Performs a single load or store against the cache.
+ *
+ * Parameters:
+ *   type - 'l' for a load or 's' for a store
+ *   address - The 32-bit memory address being accessed
+ *   bytes - Size of the access in bytes (0 for a word)
+ *
+ * Returns:
+ *   0 on success, 1 if the type is not a load or a store.
+ */
+int Simulator::access(char type, uint32_t address, int bytes) {
+    if (type != 'l' && type != 's') {
+        return 1;
+    }
+    accessBytes = bytes > 0 ? bytes : 4;
+    if (tlb) {
+        translate(address);
+    }
+    if (type == 'l') {
+        // writes to loads/stores to/from memory take 100 cycles
+        load(address);
+        loads++;
+    }
+    else {
+        store(address);
+        stores++;
+    }
+    ticks++;
+    return 0;
+}
+
+/*
+ * Translates an address through the TLB. A miss in every level walks the
+ * page table, reading each entry through the data cache, and the walk's
+ * cycles land in the total like any other access.
+ *
+ * Parameters:
+ *   address - The virtual address being accessed
+ */
+void Simulator::translate(uint32_t address) {
+    Tlb::Result result = tlb->translate(address);
+    if (result == Tlb::Result::L1Hit) {
+        tlbL1Hits++;
+        return;
+    }
+    tlbL1Misses++;
+    if (result == Tlb::Result::L2Hit) {
+        tlbL2Hits++;
+        cycles += TLB_L2_HIT_CYCLES;
+        return;
+    }
+    tlbL2Misses++;
+    uint64_t before = cycles;
+    int dataBytes = accessBytes;
+    accessBytes = 8; // page table entries are 8 bytes
+    for (uint32_t entry : tlb->walk(address)) {
+        if (readBlock(entry)) {
+            walkHits++;
+        }
+        else {
+            walkMisses++;
+        }
+        ticks++;
+    }
+    accessBytes = dataBytes;
+    walkCycles += cycles - before;
+}
+
 /*
  * Converts a 32-bit unsigned integer address to a binary representation.
  *
@@ -127,6 +468,26 @@ int Simulator::toBinary(uint32_t address) {
  */
 void Simulator::updateCache(uint32_t tag, bool valid, bool dirty, uint32_t load_ts, uint32_t access_ts, int index,
                             int block) {
+    if (options.sectorSize > 0) {
+        // a new block holds only the sectors that were brought in
+        setSectors(index, block, currentSectors, dirty ? currentSectors : 0);
+    }
+    if (currentTenant >= 0) {
+        // the filled slot changes hands
+        if (isValid(index, block)) {
+            tenantStats[getOwner(index, block)].occupancy--;
+        }
+        setOwner(index, block, currentTenant);
+        tenantStats[currentTenant].occupancy++;
+    }
+    if (nextUses) {
+        nextUses->update(index, block, currentNextUse);
+    }
+    if (compactCache) {
+        // the compact layout keeps a replacement order instead of timestamps
+        compactCache->fill(index, block, tag, dirty);
+        return;
+    }
     cache.sets[index].slots[block].tag = tag;
     cache.sets[index].slots[block].dirty = dirty;
     cache.sets[index].slots[block].valid = valid;
@@ -134,6 +495,122 @@ void Simulator::updateCache(uint32_t tag, bool valid, bool dirty, uint32_t load_
     cache.sets[index].slots[block].load_ts = load_ts;
 }
 
+/*
+ * Slot accessors that work on either the default or the compact layout.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ */
+bool Simulator::isValid(int index, int block) const {
+    if (compactCache) {
+        return compactCache->valid(index, block);
+    }
+    return cache.sets[index].slots[block].valid;
+}
+
+bool Simulator::isDirty(int index, int block) const {
+    if (compactCache) {
+        return compactCache->dirty(index, block);
+    }
+    return cache.sets[index].slots[block].dirty;
+}
+
+uint32_t Simulator::getTag(int index, int block) const {
+    if (compactCache) {
+        return compactCache->tag(index, block);
+    }
+    return cache.sets[index].slots[block].tag;
+}
+
+void Simulator::setDirty(int index, int block) {
+    if (options.sectorSize > 0) {
+        setSectors(index, block, validSectors(index, block), dirtySectors(index, block) | currentSectors);
+    }
+    if (compactCache) {
+        compactCache->setDirty(index, block);
+        return;
+    }
+    cache.sets[index].slots[block].dirty = true;
+}
+
+/*
+ * Sector state accessors that work on either layout, one bit per sector.
+ * Only meaningful when blocks are sectored.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   valid - Sectors the slot holds
+ *   dirty - Sectors the slot has modified
+ */
+uint64_t Simulator::validSectors(int index, int block) const {
+    if (compactCache) {
+        return compactCache->sectorValid(index, block);
+    }
+    return sectorValid[(size_t)index * blocks + block];
+}
+
+uint64_t Simulator::dirtySectors(int index, int block) const {
+    if (compactCache) {
+        return compactCache->sectorDirty(index, block);
+    }
+    return sectorDirty[(size_t)index * blocks + block];
+}
+
+void Simulator::setSectors(int index, int block, uint64_t valid, uint64_t dirty) {
+    if (compactCache) {
+        compactCache->setSectors(index, block, valid, dirty);
+        return;
+    }
+    sectorValid[(size_t)index * blocks + block] = valid;
+    sectorDirty[(size_t)index * blocks + block] = dirty;
+}
+
+/*
+ * Owner accessors that work on either layout. Only meaningful in tenant mode.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   tenant - The tenant that filled the slot
+ */
+int Simulator::getOwner(int index, int block) const {
+    if (compactCache) {
+        return compactCache->owner(index, block);
+    }
+    return owners[(size_t)index * blocks + block];
+}
+
+void Simulator::setOwner(int index, int block, int tenant) {
+    if (compactCache) {
+        compactCache->setOwner(index, block, tenant);
+        return;
+    }
+    owners[(size_t)index * blocks + block] = tenant;
+}
+
+/*
+ * Records an access to a cache block for the LRU eviction policy.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ */
+void Simulator::touch(int index, int block) {
+    if (nextUses) {
+        nextUses->update(index, block, currentNextUse);
+    }
+    if (compactCache) {
+        // fifo order only changes when a block is loaded
+        if (evictionPolicy == EvictionPolicy::LRU) {
+            compactCache->touch(index, block);
+        }
+        return;
+    }
+    cache.sets[index].slots[block].access_ts = ticks; // update time for lru
+}
+
 
 /*
  * Selects a block to evict from a cache set based on the FIFO eviction policy.
@@ -146,20 +623,26 @@ void Simulator::updateCache(uint32_t tag, bool valid, bool dirty, uint32_t load_
  *   The index of the block within the set to be evicted.
  */
 int Simulator::fifo(int index) {
-    uint32_t minLoadTs = cache.sets[index].slots[0].load_ts;
-    int evictBlock = 0;
-    // loop through to find the earliest load
-    for (int i = 1; i < blocks; ++i) { 
+    if (compactCache) {
+        int evictBlock = compactCache->oldest(index, allowedWays());
+        writeBack(index, evictBlock);
+        return evictBlock;
+    }
+    uint32_t minLoadTs = 0;
+    int evictBlock = -1;
+    // loop through to find the earliest load among ways we may fill
+    for (int i = 0; i < blocks; ++i) { 
+        if (!wayAllowed(i)) {
+            continue;
+        }
         uint32_t curLoadTs = cache.sets[index].slots[i].load_ts;
-        if (curLoadTs < minLoadTs) {
+        if (evictBlock < 0 || curLoadTs < minLoadTs) {
             minLoadTs = curLoadTs;
             evictBlock = i;
         }
     }
-    if (cache.sets[index].slots[evictBlock].dirty == true) {
-        // if dirty write to memory
-        cycles += 100 * memoryMultiplier;
-    }
+    // if dirty write to memory
+    writeBack(index, evictBlock);
     return evictBlock;
 }
 
@@ -176,27 +659,48 @@ int Simulator::fifo(int index) {
  */
 int Simulator::lru(int index)
 {
-    uint32_t minAccessTs = cache.sets[index].slots[0].access_ts;
-    int evictBlock = 0;
-    // loop through to find the earliest access
-    for (int i = 1; i < blocks; ++i) { 
+    if (compactCache) {
+        // the compact order tracks accesses under lru
+        return fifo(index);
+    }
+    uint32_t minAccessTs = 0;
+    int evictBlock = -1;
+    // loop through to find the earliest access among ways we may fill
+    for (int i = 0; i < blocks; ++i) { 
+        if (!wayAllowed(i)) {
+            continue;
+        }
         uint32_t curAccessTs = cache.sets[index].slots[i].access_ts;
-        if (curAccessTs < minAccessTs) {
+        if (evictBlock < 0 || curAccessTs < minAccessTs) {
             minAccessTs = curAccessTs;
             evictBlock = i;
         }
     }
     // if dirty write to memory
-    if (cache.sets[index].slots[evictBlock].dirty == true) {
-        
-        cycles += 100 * memoryMultiplier;
-    }
+    writeBack(index, evictBlock);
+    return evictBlock;
+}
+
+/*
+ * Selects a block to evict based on the optimal (Belady) eviction policy.
+ * Identifies the block whose next access is furthest in the future.
+ *
+ * Parameters:
+ *   index - Index of the cache set from which a block is to be evicted
+ *
+ * Returns:
+ *   The index of the block within the set to be evicted.
+ */
+int Simulator::opt(int index) {
+    int evictBlock = nextUses->furthest(index);
+    // if dirty write to memory
+    writeBack(index, evictBlock);
     return evictBlock;
 }
 
 /*
  * Evicts a block from a specified cache set.
- * Calls either fifo() or lru() based on the Simulator's evictionPolicy.
+ * Calls fifo(), lru() or opt() based on the Simulator's evictionPolicy.
  *
  * Parameters:
  *   index - Index of the cache set from which a block is to be evicted
@@ -208,6 +712,9 @@ int Simulator::evict(int index) {
     if (static_cast<int>(evictionPolicy) == 1) { // fifo
         return fifo(index);
     }
+    else if (evictionPolicy == EvictionPolicy::OPT) {
+        return opt(index);
+    }
     else
     {
         return lru(index);
@@ -216,77 +723,118 @@ int Simulator::evict(int index) {
 
 
 /*
- * Loads a data block into the cache based on a given address string.
+ * Loads a data block into the cache based on a given address and counts
+ * the load as a hit or a miss.
+ *
+ * Parameters:
+ *   address - The memory address to load from
+ */
+void Simulator::load(uint32_t address) {
+    if (readBlock(address)) {
+        lhits++;
+    }
+    else {
+        lmisses++;
+    }
+}
+
+/*
+ * Reads a data block through the cache based on a given address.
  * The function calculates the cache index, tag from the address, and checks for cache hits.
  * Handles cache misses by either loading data into an empty block or evicting an existing block.
- * Updates the relevant cache statistics accordingly.
+ * Updates the cycle count accordingly.
  *
  * Parameters:
- *   sAddress - The memory address in hexadecimal string format to load from
+ *   address - The memory address to read from
+ *
+ * Returns:
+ *   True on a cache hit, False on a miss.
  */
-void Simulator::load(string sAddress) {
-    // convert from string to binary
-    unsigned int address = toBinary(stoul(sAddress, nullptr, 16));
+bool Simulator::readBlock(uint32_t address) {
     // Calculate bit lengths
     unsigned int offsetBits = log2(size);
     unsigned int indexBits = log2(sets);
     // Extract index
     unsigned int indexMask = (1 << indexBits) - 1;
-    unsigned int index = (address >> offsetBits) & indexMask;
+    unsigned int index = blockNumber(address, offsetBits) & indexMask;
     // Extract tag
-    unsigned int tag = address >> (offsetBits + indexBits);
+    unsigned int tag = blockNumber(address, offsetBits) >> indexBits;
     int emptyBlock = -1;
     // check if in cache, block will describe if it's a miss or the index to
     // write to, or if all blocks are occupied
     int block = checkMem(tag, index, emptyBlock);
+    currentSectors = sectorsTouched(address);
+    currentBlock = blockNumber(address, offsetBits);
     if (block < 0 || block == blocks) {                                     // miss
-        cycles += 100 * memoryMultiplier; // miss needs to load from memory into cache
-        lmisses++;
+        readMemory(__builtin_popcountll(currentSectors)); // miss needs to load from memory into cache
         if (block == blocks) { // cache is full we neec to evict
             emptyBlock = evict(index);
-            updateCache(tag, true, false, loads + stores, loads + stores, index, emptyBlock); // updating the cache
+            updateCache(tag, true, false, ticks, ticks, index, emptyBlock); // updating the cache
         }
         else { // cache is not full
-            updateCache(tag, true, false, loads + stores, loads + stores, index, emptyBlock); // updating the cache
+            updateCache(tag, true, false, ticks, ticks, index, emptyBlock); // updating the cache
         }
+        return false;
     }
-    else {                // hit
-        cycles += 1; // load from cache
-        lhits++;
-        cache.sets[index].slots[block].access_ts = loads + stores; // update time for lru
+    uint64_t missing = missingSectors(index, block);
+    if (missing != 0) { // block is here but part of what we need is not
+        sectorMisses++;
+        readMemory(__builtin_popcountll(missing));
+        setSectors(index, block, validSectors(index, block) | missing, dirtySectors(index, block));
+        touch(index, block);
+        return false;
     }
+    // hit
+    cycles += 1; // load from cache
+    touch(index, block);
+    return true;
 }
 
 /*
- * Stores a data block into the cache based on a given address string.
+ * Stores a data block into the cache based on a given address.
  * The function calculates the cache index, tag from the address, and checks for cache hits.
  * Handles cache misses according to the write miss policy by either ignoring the cache or updating it.
  * Updates the relevant cache statistics and state based on the write policy.
  *
  * Parameters:
- *   sAddress - The memory address in hexadecimal string format to store to
+ *   address - The memory address to store to
  */
-void Simulator::store(string sAddress) {
-    unsigned int address = stoul(sAddress, nullptr, 16);
+void Simulator::store(uint32_t address) {
     // Calculate bit lengths
     unsigned int offsetBits = log2(size);
     unsigned int indexBits = log2(sets);
 
     // Extract index
     unsigned int indexMask = (1 << indexBits) - 1;
-    unsigned int index = (address >> offsetBits) & indexMask;
+    unsigned int index = blockNumber(address, offsetBits) & indexMask;
 
     // Extract tag
-    unsigned int tag = address >> (offsetBits + indexBits);
+    unsigned int tag = blockNumber(address, offsetBits) >> indexBits;
 
     // check if in cache
     int emptyBlock = -1;
     int block = checkMem(tag, index, emptyBlock);
+    currentSectors = sectorsTouched(address);
+    currentBlock = blockNumber(address, offsetBits);
     // miss
     if (block < 0 || block == blocks) {
         writeMiss(tag, index, block, emptyBlock); // if miss
         smisses += 1;
     }
+    else if (missingSectors(index, block) != 0) { // block is here but the stored sectors are not
+        smisses += 1;
+        sectorMisses++;
+        if (static_cast<int>(missPolicy) == 1) { // nowrite allocate
+            writeMemory();
+        }
+        else { // write allocate fills only the missing sectors
+            uint64_t missing = missingSectors(index, block);
+            readMemory(__builtin_popcountll(missing));
+            setSectors(index, block, validSectors(index, block) | missing, dirtySectors(index, block));
+            cycles += 1; // store to cache
+            writeHit(index, block);
+        }
+    }
     else { // hit
         cycles += 1; // store to cache
         shits += 1;  // if hit
@@ -303,13 +851,13 @@ void Simulator::store(string sAddress) {
  *   inputBlock - Block number within the set to be updated
  */
 void Simulator::writeHit(int index, int inputBlock) {
-    cache.sets[index].slots[inputBlock].access_ts = loads + stores; // update time for lru
+    touch(index, inputBlock);
     //Write Back
     if (static_cast<int>(writePolicy) == 1) { 
-        cache.sets[index].slots[inputBlock].dirty = true; // block is dirty
+        setDirty(index, inputBlock); // block is dirty
     }
     else  { // write through
-        cycles += 100; // write through also stores to memory
+        writeMemory(); // write through also stores to memory
     }
 }
 
@@ -327,12 +875,12 @@ void Simulator::writeHit(int index, int inputBlock) {
 void Simulator::writeMiss(uint32_t tag, int index, int inputBlock, int emptyInd) {
     // nowrite allocate
     if (static_cast<int>(missPolicy) == 1) {
-        cycles += 100; // write to memory
+        writeMemory(); // write to memory
     }
     // write allocate
     else {
         // bring relevant memory block into cache before store
-        cycles += 100 * memoryMultiplier; 
+        readMemory(__builtin_popcountll(currentSectors));
         //if cache was full our "empty" index is now where we are evicting                                     
         if (inputBlock == blocks) {
             emptyInd = evict(index);
@@ -340,20 +888,105 @@ void Simulator::writeMiss(uint32_t tag, int index, int inputBlock, int emptyInd)
         // WriteBack
         if (static_cast<int>(writePolicy) == 1) {
             // updating cache in the empty or evicted index depending on whether all blocks were used
-            updateCache(tag, true, true, loads + stores, loads + stores, index,
+            updateCache(tag, true, true, ticks, ticks, index,
                         emptyInd); // write_back so mark as dirty
             cycles += 1;           // write to cache
         }
         else { // Write Through
-            cycles += 100; // write to memory
+            writeMemory(); // write to memory
             cycles += 1;   // also write to cache
             // updating cache in the empty or evicted index depending on whether
             // all blocks were used
-            updateCache(tag, true, false, loads + stores, loads + stores, index, emptyInd);
+            updateCache(tag, true, false, ticks, ticks, index, emptyInd);
         }
     }
 }
 
+/*
+ * Finds the sectors of a block that the current access touches. Without
+ * sectors the whole block is a single sector.
+ *
+ * Parameters:
+ *   address - The memory address being accessed
+ *
+ * Returns:
+ *   One bit per sector touched, clipped to the end of the block.
+ */
+uint64_t Simulator::sectorsTouched(uint32_t address) const {
+    if (options.sectorSize == 0) {
+        return 1;
+    }
+    unsigned int offset = address & (size - 1);
+    unsigned int last = std::min<unsigned int>(offset + accessBytes - 1, size - 1);
+    int first = offset / sectorBytes;
+    int count = last / sectorBytes - first + 1;
+    uint64_t mask = count == 64 ? ~0ULL : (1ULL << count) - 1;
+    return mask << first;
+}
+
+/*
+ * Finds the touched sectors that a cached block does not hold yet.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *
+ * Returns:
+ *   One bit per missing sector, always 0 without sectors.
+ */
+uint64_t Simulator::missingSectors(int index, int block) const {
+    if (options.sectorSize == 0) {
+        return 0;
+    }
+    return currentSectors & ~validSectors(index, block);
+}
+
+/*
+ * Charges for reading sectors from memory into the cache.
+ *
+ * Parameters:
+ *   count - Number of sectors read
+ */
+void Simulator::readMemory(int count) {
+    cycles += 100 * memoryMultiplier * count;
+    bytesRead += (uint64_t)count * sectorBytes;
+    if (missStream) {
+        missStream->write('l', currentBlock, currentSequence);
+    }
+}
+
+/*
+ * Charges for writing the current access straight to memory.
+ */
+void Simulator::writeMemory() {
+    cycles += 100;
+    bytesWritten += accessBytes;
+    if (missStream) {
+        missStream->write('s', currentBlock, currentSequence);
+    }
+}
+
+/*
+ * Charges for writing a block's dirty data back to memory when it is evicted.
+ * A sectored block only writes back its dirty sectors.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ */
+void Simulator::writeBack(int index, int block) {
+    int count = isDirty(index, block) ? 1 : 0;
+    if (options.sectorSize > 0) {
+        count = __builtin_popcountll(dirtySectors(index, block));
+    }
+    cycles += 100 * memoryMultiplier * count;
+    bytesWritten += (uint64_t)count * sectorBytes;
+    if (missStream && count > 0) {
+        // the evicted block's number is its tag followed by the set index
+        missStream->write('s', (getTag(index, block) << (int)log2(sets)) | index, currentSequence);
+    }
+}
+
 /*
  * Checks if a given tag is present in the specified cache set.
  * It also identifies an empty block in the set if one exists.
@@ -368,46 +1001,113 @@ void Simulator::writeMiss(uint32_t tag, int index, int inputBlock, int emptyInd)
  *   -1 if an empty block is found, or the number of allocated blocks indicating a miss and there are no empty blocks.
  */
 int Simulator::checkMem(uint32_t tag, int index, int &emptyBlock) {
-    if (index >= (int)cache.sets.size()) {
+    if (index >= sets) {
         return -1;
     }
-    Set curSet = cache.sets[index];
     int numAllocated = 0;
+    bool foundEmpty = false;
     // go through all blocks and see if tags match
     for (int i = 0; i < blocks; ++i) {
-        // block found from index
-        Slot block = curSet.slots[i];
         // check valid
-        if (!block.valid) {
-            emptyBlock = i; // storing to reference to indicate an empty place in cache to use
+        if (!isValid(index, i)) {
+            // only ways the current tenant may fill count as empty
+            if (wayAllowed(i)) {
+                emptyBlock = i; // storing to reference to indicate an empty place in cache to use
+                foundEmpty = true;
+            }
             continue;
         }
-        // if tags match, then we have a "hit"
-        if (block.tag == tag) {
+        // if tags match, then we have a "hit", but tenants never share blocks
+        if (getTag(index, i) == tag && (currentTenant < 0 || getOwner(index, i) == currentTenant)) {
             emptyBlock = i;
             return i;
         }
         numAllocated += 1;
     }
-    if (numAllocated < blocks) { //miss but there are empty blocks
+    if (foundEmpty) { //miss but there are empty blocks
         return -1;
     }
     // if we iterate through all lines within all sets, then we have a "miss", and all blocks are full so we return to indicate all blocks are full
-    return numAllocated;
+    return blocks;
+}
+
+/*
+ * Formats a number with two decimals.
+ */
+static string decimal(double value) {
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    oss.precision(2);
+    oss << value;
+    return oss.str();
+}
+
+/*
+ * Formats part of a whole as a percentage with two decimals.
+ */
+static string percent(long part, long whole) {
+    return decimal(whole == 0 ? 0.0 : 100.0 * part / whole);
 }
 
 /*
- * Prints the simulation's final statistics to standard output, including total loads,
+ * Prints the simulation's final statistics, including total loads,
  * stores, hits, misses, and the total number of cycles taken.
+ *
+ * Parameters:
+ *   out - The stream to print to (standard output by default)
  */
-void Simulator::print() {
-    cout << "Total loads: " << loads << endl;
-    cout << "Total stores: " << stores << endl;
-    cout << "Load hits: " << lhits << endl;
-    cout << "Load misses: " << lmisses << endl;
-    cout << "Store hits: " << shits << endl;
-    cout << "Store misses: " << smisses << endl;
-    cout << "Total cycles: " << cycles << endl;
+void Simulator::print(std::ostream &out) {
+    out << "Total loads: " << loads << endl;
+    out << "Total stores: " << stores << endl;
+    out << "Load hits: " << lhits << endl;
+    out << "Load misses: " << lmisses << endl;
+    out << "Store hits: " << shits << endl;
+    out << "Store misses: " << smisses << endl;
+    out << "Total cycles: " << cycles << endl;
+    if (compactCache) {
+        out << "Metadata bits per block: " << compactCache->bitsPerBlock() << endl;
+        out << "Metadata bytes reserved: " << compactCache->reservedBytes() << endl;
+        out << "Metadata bytes resident: " << compactCache->residentBytes() << endl;
+    }
+    if (tlb) {
+        int translations = tlbL1Hits + tlbL1Misses;
+        out << "L1 dTLB hits: " << tlbL1Hits << endl;
+        out << "L1 dTLB misses: " << tlbL1Misses << endl;
+        out << "L1 dTLB hit rate: " << percent(tlbL1Hits, translations) << "%" << endl;
+        if (tlb->hasL2()) {
+            out << "L2 TLB hits: " << tlbL2Hits << endl;
+            out << "L2 TLB misses: " << tlbL2Misses << endl;
+            out << "L2 TLB hit rate: " << percent(tlbL2Hits, tlbL1Misses) << "%" << endl;
+        }
+        out << "Page walks: " << tlbL2Misses << endl;
+        out << "Page walk cache hits: " << walkHits << endl;
+        out << "Page walk cache misses: " << walkMisses << endl;
+        out << "Page walk cycles: " << walkCycles << endl;
+    }
+    if (options.sectorSize > 0) {
+        out << "Sector misses: " << sectorMisses << endl;
+        out << "Bytes read from memory: " << bytesRead << endl;
+        out << "Bytes written to memory: " << bytesWritten << endl;
+    }
+    if (missStream) {
+        out << "Miss stream records: " << missStream->count() << endl;
+    }
+    for (size_t t = 0; t < tenantStats.size(); ++t) {
+        const TenantStats &stats = tenantStats[t];
+        string label = "Tenant " + std::to_string(t) + " ";
+        uint64_t accesses = loads + stores;
+        out << label << "trace: " << options.tenantTraces[t] << endl;
+        out << label << "loads: " << stats.loads << endl;
+        out << label << "stores: " << stats.stores << endl;
+        out << label << "load hits: " << stats.lhits << endl;
+        out << label << "load misses: " << stats.lmisses << endl;
+        out << label << "store hits: " << stats.shits << endl;
+        out << label << "store misses: " << stats.smisses << endl;
+        out << label << "cycles: " << stats.cycles << endl;
+        out << label << "occupancy: " << stats.occupancy << " blocks" << endl;
+        out << label << "average occupancy: "
+            << decimal(accesses == 0 ? 0.0 : (double)stats.occupancySum / accesses) << " blocks" << endl;
+    }
 }
 
 
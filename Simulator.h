@@ -13,12 +13,38 @@
 #include <stdint.h>
 
 #include <bitset>
+#include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
+
+#include "CompactCache.h"
+#include "Opt.h"
+#include "Tlb.h"
+
+class MissStreamWriter;
+
 // Policies
 enum class WriteMissPolicy { WriteAllocate, NoWriteAllocate };
-enum class EvictionPolicy { LRU, FIFO };
+enum class EvictionPolicy { LRU, FIFO, OPT };
 enum class WritePolicy { WriteThrough, WriteBack };
+enum class TenantSchedule { RoundRobin, Weighted, Timestamp };
+
+// A decoded trace record
+struct AccessRecord {
+  uint32_t address;
+  uint8_t type;  // 'l' or 's'
+  uint8_t size;  // access size in bytes, as in the trace's third column
+  uint16_t reserved;
+};
+
+static_assert(sizeof(AccessRecord) == 8, "AccessRecord must be packed");
+
+// Block number of an address: the address without its block offset bits
+inline uint32_t blockNumber(uint32_t address, int offsetBits) {
+    return address >> offsetBits;
+}
 
 // Cache Data Structure
 struct Slot {
@@ -37,6 +63,38 @@ struct Cache {
   std::vector<Set> sets;
 };
 
+// Optional Features
+struct SimOptions {
+  // keep slot metadata bit-packed in a lazily backed arena
+  bool compact = false;
+  // translate every access through a TLB model
+  bool tlb = false;
+  TlbConfig tlbConfig;
+  // replay several traces into one shared cache
+  std::vector<std::string> tenantTraces;
+  TenantSchedule schedule = TenantSchedule::RoundRobin;
+  std::vector<int> tenantWeights;
+  // ways each tenant may fill, one bit per way; empty means unpartitioned
+  std::vector<uint64_t> wayMasks;
+  // split blocks into sectors of this many bytes, 0 for whole blocks
+  int sectorSize = 0;
+  // write every memory read and write to this file as a miss stream
+  std::string missStream;
+};
+
+// Per-Tenant Statistics
+struct TenantStats {
+  uint32_t loads = 0;
+  uint32_t stores = 0;
+  int lhits = 0;
+  int lmisses = 0;
+  int shits = 0;
+  int smisses = 0;
+  uint64_t cycles = 0;
+  int occupancy = 0;          // blocks currently filled by the tenant
+  uint64_t occupancySum = 0;  // occupancy summed over every access, for the average
+};
+
 // Class Definition
 class Simulator {
  public:
@@ -51,10 +109,12 @@ class Simulator {
  *   size - Size of each block in bytes
  *   miss - Policy for handling write misses (No-write allocate / Write-allocate)
  *   write - Policy for write operations (Write-through / Write-back)
- *   eviction - Policy for eviction (LRU / FIFO)
+ *   eviction - Policy for eviction (LRU / FIFO / OPT)
+ *   options - Optional features to enable
  */
   Simulator(int sets, int blocks, int size, WriteMissPolicy write,
-            WritePolicy miss, EvictionPolicy evictio);
+            WritePolicy miss, EvictionPolicy evictio,
+            const SimOptions &options = SimOptions());
 
   /*
  * Destructor for the Simulator class.
@@ -73,10 +133,39 @@ class Simulator {
   int simulate();
 
 /*
- * Prints the simulation's final statistics to standard output, including total loads,
+ * Reports whether the simulation has to read its own input: opt needs the
+ * whole trace up front, and tenant mode reads its own trace files. Such a
+ * simulator cannot be fed one access at a time through access().
+ */
+  bool needsOwnInput() const;
+
+/*
+ * Reports whether the simulation writes a miss stream, which only happens
+ * while simulate() runs.
+ */
+  bool exportsMisses() const;
+
+/*
+ * Performs a single load or store against the cache.
+ *
+ * Parameters:
+ *   type - 'l' for a load or 's' for a store
+ *   address - The 32-bit memory address being accessed
+ *   bytes - Size of the access in bytes (0 for a word)
+ *
+ * Returns:
+ *   0 on success, 1 if the type is not a load or a store.
+ */
+  int access(char type, uint32_t address, int bytes = 4);
+
+/*
+ * Prints the simulation's final statistics, including total loads,
  * stores, hits, misses, and the total number of cycles taken.
+ *
+ * Parameters:
+ *   out - The stream to print to (standard output by default)
  */
-  void print();
+  void print(std::ostream &out = std::cout);
 
  private:
   /* Variables */
@@ -96,34 +185,180 @@ class Simulator {
   int lmisses;
   int shits;
   int smisses;
-  int cycles;
+  uint64_t cycles;
   int memoryMultiplier;
+  uint32_t ticks; // one per cache reference, orders slots for lru/fifo
+  // Translation Statistics
+  int tlbL1Hits;
+  int tlbL1Misses;
+  int tlbL2Hits;
+  int tlbL2Misses;
+  int walkHits;
+  int walkMisses;
+  uint64_t walkCycles;
+  // Next use of the access being simulated, for opt
+  uint64_t currentNextUse;
+  // Sectors
+  int sectorBytes; // equal to size when blocks are not sectored
+  int accessBytes; // size of the access being simulated
+  uint64_t currentSectors; // sectors of the block the access touches
+  int sectorMisses;
+  uint64_t bytesRead;
+  uint64_t bytesWritten;
+  // Miss stream
+  uint64_t currentSequence; // position of the access being simulated in the original trace
+  uint32_t currentBlock; // block number of the access being simulated
+  std::shared_ptr<MissStreamWriter> missStream; // shared by copies, opened by simulate()
   // Cache
+  SimOptions options;
   Cache cache;
+  std::optional<CompactCache> compactCache;
+  std::optional<Tlb> tlb;
+  std::optional<NextUseHeap> nextUses;
+  // Tenants
+  int currentTenant; // -1 outside tenant mode
+  std::vector<TenantStats> tenantStats;
+  std::vector<int> owners; // tenant that filled each slot, default layout only
+  std::vector<uint64_t> sectorValid; // per slot, sectored default layout only
+  std::vector<uint64_t> sectorDirty;
   // Memory
   /* Methods */
+/*
+ * Simulates the accesses on standard input, which may be a text trace or a
+ * miss stream written by another run.
+ *
+ * Returns:
+ *   0 on successful simulation, 1 on encountering invalid input.
+ */
+  int simulateTrace();
+
+/*
+ * Simulates the cache with optimal (Belady) replacement. The trace is decoded
+ * to a temporary file, a backward pass records each access's next use of the
+ * same block, and a forward pass replays the trace with those next uses.
+ * Every pass works a chunk at a time, so memory grows with the number of
+ * distinct blocks in the trace rather than with its length.
+ *
+ * Returns:
+ *   0 on successful simulation, 1 on invalid input or a temporary file error.
+ */
+  int simulateOffline();
+
+/*
+ * Simulates several tenants sharing the cache. Their traces are interleaved
+ * by the configured schedule and every access is charged to its tenant.
+ *
+ * Returns:
+ *   0 on successful simulation, 1 on an unreadable trace or invalid input.
+ */
+  int simulateTenants();
+
+/*
+ * Checks whether the current tenant may fill a way under way partitioning.
+ *
+ * Parameters:
+ *   block - Block number within a set
+ *
+ * Returns:
+ *   True if the way is in the tenant's mask or the cache is unpartitioned.
+ */
+  bool wayAllowed(int block) const;
+
+/*
+ * Builds the current tenant's way mask for the compact layout.
+ */
+  uint64_t allowedWays() const;
  
 /*
- * Loads a data block into the cache based on a given address string.
+ * Loads a data block into the cache based on a given address and counts
+ * the load as a hit or a miss.
+ *
+ * Parameters:
+ *   address - The memory address to load from
+ */
+  void load(uint32_t address);
+
+/*
+ * Reads a data block through the cache based on a given address.
  * The function calculates the cache index, tag from the address, and checks for cache hits.
  * Handles cache misses by either loading data into an empty block or evicting an existing block.
- * Updates the relevant cache statistics accordingly.
+ * Updates the cycle count accordingly.
+ *
+ * Parameters:
+ *   address - The memory address to read from
+ *
+ * Returns:
+ *   True on a cache hit, False on a miss.
+ */
+  bool readBlock(uint32_t address);
+
+/*
+ * Translates an address through the TLB. A miss in every level walks the
+ * page table, reading each entry through the data cache, and the walk's
+ * cycles land in the total like any other access.
  *
  * Parameters:
- *   sAddress - The memory address in hexadecimal string format to load from
+ *   address - The virtual address being accessed
  */
-  void load(std::string address);
+  void translate(uint32_t address);
 
 /*
- * Stores a data block into the cache based on a given address string.
+ * Stores a data block into the cache based on a given address.
  * The function calculates the cache index, tag from the address, and checks for cache hits.
  * Handles cache misses according to the write miss policy by either ignoring the cache or updating it.
  * Updates the relevant cache statistics and state based on the write policy.
  *
  * Parameters:
- *   sAddress - The memory address in hexadecimal string format to store to
+ *   address - The memory address to store to
  */
-  void store(std::string address);
+  void store(uint32_t address);
+
+/*
+ * Finds the sectors of a block that the current access touches. Without
+ * sectors the whole block is a single sector.
+ *
+ * Parameters:
+ *   address - The memory address being accessed
+ *
+ * Returns:
+ *   One bit per sector touched, clipped to the end of the block.
+ */
+  uint64_t sectorsTouched(uint32_t address) const;
+
+/*
+ * Finds the touched sectors that a cached block does not hold yet.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *
+ * Returns:
+ *   One bit per missing sector, always 0 without sectors.
+ */
+  uint64_t missingSectors(int index, int block) const;
+
+/*
+ * Charges for reading sectors from memory into the cache.
+ *
+ * Parameters:
+ *   count - Number of sectors read
+ */
+  void readMemory(int count);
+
+/*
+ * Charges for writing the current access straight to memory.
+ */
+  void writeMemory();
+
+/*
+ * Charges for writing a block's dirty data back to memory when it is evicted.
+ * A sectored block only writes back its dirty sectors.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ */
+  void writeBack(int index, int block);
 
 /*
  * Checks if a given tag is present in the specified cache set.
@@ -176,6 +411,52 @@ class Simulator {
  */
   void updateCache(uint32_t tag, bool valid, bool dirty, uint32_t load_ts,
                    uint32_t access_ts, int index, int block);
+
+/*
+ * Slot accessors that work on either the default or the compact layout.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ */
+  bool isValid(int index, int block) const;
+  bool isDirty(int index, int block) const;
+  uint32_t getTag(int index, int block) const;
+  void setDirty(int index, int block);
+
+/*
+ * Sector state accessors that work on either layout, one bit per sector.
+ * Only meaningful when blocks are sectored.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   valid - Sectors the slot holds
+ *   dirty - Sectors the slot has modified
+ */
+  uint64_t validSectors(int index, int block) const;
+  uint64_t dirtySectors(int index, int block) const;
+  void setSectors(int index, int block, uint64_t valid, uint64_t dirty);
+
+/*
+ * Owner accessors that work on either layout. Only meaningful in tenant mode.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ *   tenant - The tenant that filled the slot
+ */
+  int getOwner(int index, int block) const;
+  void setOwner(int index, int block, int tenant);
+
+/*
+ * Records an access to a cache block for the LRU eviction policy.
+ *
+ * Parameters:
+ *   index - Index of the set
+ *   block - Block number within the set
+ */
+  void touch(int index, int block);
 /*
  * Selects a block to evict from a cache set based on the FIFO eviction policy.
  * Identifies the block that was loaded earliest among all blocks in the specified set.
@@ -198,9 +479,20 @@ class Simulator {
  *   The index of the block within the set to be evicted.
  */
   int lru(int index);
+/*
+ * Selects a block to evict based on the optimal (Belady) eviction policy.
+ * Identifies the block whose next access is furthest in the future.
+ *
+ * Parameters:
+ *   index - Index of the cache set from which a block is to be evicted
+ *
+ * Returns:
+ *   The index of the block within the set to be evicted.
+ */
+  int opt(int index);
 /*
  * Evicts a block from a specified cache set.
- * Calls either fifo() or lru() based on the Simulator's evictionPolicy.
+ * Calls fifo(), lru() or opt() based on the Simulator's evictionPolicy.
  *
  * Parameters:
  *   index - Index of the cache set from which a block is to be evicted
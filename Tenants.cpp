@@ -0,0 +1,142 @@
+/*
+ * Multi-tenant trace interleaving implementations for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Libraries and Files
+#include "Tenants.h"
+
+// Statements
+using std::string;
+using std::vector;
+
+/*
+ * Constructor for the TenantMerger class. Opens every trace.
+ *
+ * Parameters:
+ *   paths - Trace file of each tenant
+ *   schedule - How records are interleaved
+ *   weights - Records per turn for each tenant under Weighted
+ */
+TenantMerger::TenantMerger(const vector<string> &paths, TenantSchedule schedule, const vector<int> &weights)
+    : paths(paths), schedule(schedule), weights(weights), sources(paths.size()), current(0), issued(0)
+{
+    for (size_t i = 0; i < paths.size(); ++i) {
+        sources[i].in.open(paths[i], std::ios::binary);
+        sources[i].reader.reset(new TraceReader(sources[i].in));
+    }
+}
+
+/*
+ * Reports the first trace that could not be opened.
+ *
+ * Returns:
+ *   The path of that trace, or an empty string if every trace opened.
+ */
+string TenantMerger::unopened() const {
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (!sources[i].in.is_open()) {
+            return paths[i];
+        }
+    }
+    return "";
+}
+
+/*
+ * Makes sure a source holds its next record, reading a line if needed.
+ *
+ * Parameters:
+ *   source - The tenant's source
+ *
+ * Returns:
+ *   1 if a record is pending, 0 once the trace is finished,
+ *   -1 on invalid input.
+ */
+int TenantMerger::fill(Source &source) {
+    if (source.pending) {
+        return 1;
+    }
+    if (source.done) {
+        return 0;
+    }
+    uint64_t sequence;
+    int status = source.reader->next(source.record, sequence);
+    if (status < 0) {
+        message = source.reader->error();
+        return -1;
+    }
+    if (status == 0) {
+        source.done = true;
+        return 0;
+    }
+    source.timestamp = source.reader->timestamp();
+    source.pending = true;
+    return 1;
+}
+
+/*
+ * Produces the next record of the interleaved stream.
+ *
+ * Parameters:
+ *   tenant - Set to the tenant the record belongs to
+ *   record - Set to the record
+ *
+ * Returns:
+ *   1 if a record was produced, 0 once every trace is finished,
+ *   -1 on invalid input (see error()).
+ */
+int TenantMerger::next(int &tenant, AccessRecord &record) {
+    int count = sources.size();
+    if (schedule == TenantSchedule::Timestamp) {
+        // earliest pending record wins, ties go to the lower tenant
+        int earliest = -1;
+        for (int i = 0; i < count; ++i) {
+            int status = fill(sources[i]);
+            if (status < 0) {
+                return -1;
+            }
+            if (status == 1 && (earliest < 0 || sources[i].timestamp < sources[earliest].timestamp)) {
+                earliest = i;
+            }
+        }
+        if (earliest < 0) {
+            return 0;
+        }
+        current = earliest;
+    }
+    else {
+        // rotate until a tenant with turns left has a record
+        bool found = false;
+        for (int tries = 0; tries <= count && !found; ++tries) {
+            int turn = schedule == TenantSchedule::Weighted ? weights[current] : 1;
+            if (issued < turn) {
+                int status = fill(sources[current]);
+                if (status < 0) {
+                    return -1;
+                }
+                found = status == 1;
+            }
+            if (!found) {
+                current = (current + 1) % count;
+                issued = 0;
+            }
+        }
+        if (!found) {
+            return 0;
+        }
+        issued++;
+    }
+    tenant = current;
+    record = sources[current].record;
+    sources[current].pending = false;
+    return 1;
+}
+
+/*
+ * Describes why next() last returned -1.
+ */
+const string &TenantMerger::error() const {
+    return message;
+}
@@ -0,0 +1,95 @@
+/*
+ * Multi-tenant trace interleaving for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Guards
+#ifndef TENANTS_H
+#define TENANTS_H
+
+// Libraries and Files
+#include <stdint.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Simulator.h"
+#include "Trace.h"
+
+// Class Definition
+/*
+ * Reads several trace files and hands out their records in one stream.
+ *   RoundRobin - one record from each tenant in turn
+ *   Weighted   - tenant i issues weights[i] records per turn
+ *   Timestamp  - records in order of a fourth trace column (a decimal
+ *                timestamp); lines without one use their line number, and
+ *                miss stream records use their sequence number
+ * Traces may be text traces or miss streams, read through TraceReader.
+ * Tenants that run out drop out of the schedule while the rest continue.
+ */
+class TenantMerger {
+ public:
+  /*
+ * Constructor for the TenantMerger class. Opens every trace.
+ *
+ * Parameters:
+ *   paths - Trace file of each tenant
+ *   schedule - How records are interleaved
+ *   weights - Records per turn for each tenant under Weighted
+ */
+  TenantMerger(const std::vector<std::string> &paths, TenantSchedule schedule, const std::vector<int> &weights);
+
+/*
+ * Reports the first trace that could not be opened.
+ *
+ * Returns:
+ *   The path of that trace, or an empty string if every trace opened.
+ */
+  std::string unopened() const;
+
+/*
+ * Produces the next record of the interleaved stream.
+ *
+ * Parameters:
+ *   tenant - Set to the tenant the record belongs to
+ *   record - Set to the record
+ *
+ * Returns:
+ *   1 if a record was produced, 0 once every trace is finished,
+ *   -1 on invalid input (see error()).
+ */
+  int next(int &tenant, AccessRecord &record);
+
+/*
+ * Describes why next() last returned -1.
+ */
+  const std::string &error() const;
+
+ private:
+  struct Source {
+    std::ifstream in;
+    std::unique_ptr<TraceReader> reader;
+    bool done = false;
+    bool pending = false;  // record/timestamp hold an unread record
+    AccessRecord record = {};
+    uint64_t timestamp = 0;
+  };
+
+  /* Variables */
+  std::vector<std::string> paths;
+  TenantSchedule schedule;
+  std::vector<int> weights;
+  std::vector<Source> sources;
+  int current;
+  int issued;
+  std::string message;
+
+  /* Methods */
+  int fill(Source &source);
+};
+
+#endif
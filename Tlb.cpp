@@ -0,0 +1,138 @@
+/*
+ * TLB and page walk model implementations for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Libraries and Files
+#include "Tlb.h"
+
+#include <cmath>
+
+// Page table layout
+// Tables sit in the top gigabyte, where a 32-bit kernel keeps them. Every
+// table of one level is laid out back to back, so the entry for an address
+// at a level is simply that level's base plus (address >> lowBit) * 8.
+static const int LEVELS = 3;
+static const int LEVEL_LOW_BIT[LEVELS] = {30, 21, 12};  // root first
+static const uint32_t LEVEL_BASE[LEVELS] = {0xC0000000, 0xC0001000, 0xC1000000};
+static const int PTE_BYTES = 8;
+
+/*
+ * Constructor for the TlbArray class.
+ *
+ * Parameters:
+ *   entries - Total number of translations held
+ *   ways - Number of translations in each set
+ */
+TlbArray::TlbArray(int entries, int ways)
+    : sets(ways > 0 ? entries / ways : 0), ways(ways), clock(0), pages(entries), lastUse(entries)
+{
+}
+
+/*
+ * Looks up a page and marks it most recently used on a hit.
+ *
+ * Parameters:
+ *   page - The virtual page number
+ *
+ * Returns:
+ *   True on a hit, False on a miss.
+ */
+bool TlbArray::lookup(uint32_t page) {
+    if (sets == 0) {
+        return false;
+    }
+    int base = (page % sets) * ways;
+    for (int i = base; i < base + ways; ++i) {
+        if (lastUse[i] != 0 && pages[i] == page) {
+            lastUse[i] = ++clock;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Inserts a page, replacing the least recently used entry in its set.
+ *
+ * Parameters:
+ *   page - The virtual page number
+ */
+void TlbArray::insert(uint32_t page) {
+    if (sets == 0) {
+        return;
+    }
+    int base = (page % sets) * ways;
+    int victim = base;
+    // empty entries have the oldest possible use
+    for (int i = base + 1; i < base + ways; ++i) {
+        if (lastUse[i] < lastUse[victim]) {
+            victim = i;
+        }
+    }
+    pages[victim] = page;
+    lastUse[victim] = ++clock;
+}
+
+/*
+ * Constructor for the Tlb class.
+ *
+ * Parameters:
+ *   config - Sizes of both levels and the page size
+ */
+Tlb::Tlb(const TlbConfig &config)
+    : pageBits(log2(config.pageSize)), l1(config.l1Entries, config.l1Ways), l2(config.l2Entries, config.l2Ways),
+      l2Enabled(config.l2Entries > 0)
+{
+}
+
+/*
+ * Translates an address, filling both levels on a miss.
+ *
+ * Parameters:
+ *   address - The virtual address being accessed
+ *
+ * Returns:
+ *   Which level hit, or Miss if a page walk is needed.
+ */
+Tlb::Result Tlb::translate(uint32_t address) {
+    uint32_t page = address >> pageBits;
+    if (l1.lookup(page)) {
+        return Result::L1Hit;
+    }
+    if (l2Enabled && l2.lookup(page)) {
+        l1.insert(page);
+        return Result::L2Hit;
+    }
+    l2.insert(page);
+    l1.insert(page);
+    return Result::Miss;
+}
+
+/*
+ * Lists the page table entries a walk reads, from the root down.
+ * A huge page ends the walk at the level whose range covers its offset.
+ *
+ * Parameters:
+ *   address - The virtual address being translated
+ *
+ * Returns:
+ *   The address of each page table entry the walk reads.
+ */
+std::vector<uint32_t> Tlb::walk(uint32_t address) const {
+    std::vector<uint32_t> entries;
+    for (int level = 0; level < LEVELS; ++level) {
+        int lowBit = LEVEL_LOW_BIT[level];
+        entries.push_back(LEVEL_BASE[level] + (address >> lowBit) * PTE_BYTES);
+        if (lowBit <= pageBits) {
+            break;
+        }
+    }
+    return entries;
+}
+
+bool Tlb::hasL2() const {
+    return l2Enabled;
+}
@@ -0,0 +1,102 @@
+/*
+ * TLB and page walk model for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Guards
+#ifndef TLB_H
+#define TLB_H
+
+// Libraries and Files
+#include <stdint.h>
+
+#include <vector>
+
+// TLB Configuration
+struct TlbConfig {
+  int l1Entries = 64;    // L1 dTLB
+  int l1Ways = 4;
+  int l2Entries = 1536;  // shared L2 TLB, 0 to disable
+  int l2Ways = 12;
+  int pageSize = 4096;   // base pages, or a huge page size for every mapping
+};
+
+// A single set-associative, LRU translation array
+class TlbArray {
+ public:
+  TlbArray(int entries, int ways);
+
+/*
+ * Looks up a page and marks it most recently used on a hit.
+ *
+ * Parameters:
+ *   page - The virtual page number
+ *
+ * Returns:
+ *   True on a hit, False on a miss.
+ */
+  bool lookup(uint32_t page);
+
+/*
+ * Inserts a page, replacing the least recently used entry in its set.
+ *
+ * Parameters:
+ *   page - The virtual page number
+ */
+  void insert(uint32_t page);
+
+ private:
+  int sets;
+  int ways;
+  uint64_t clock;
+  std::vector<uint32_t> pages;
+  std::vector<uint64_t> lastUse;  // 0 marks an empty entry
+};
+
+// Class Definition
+/*
+ * Two-level data TLB in front of the cache. A miss in both levels walks a
+ * PAE-style radix page table (8-byte entries, 9 index bits per level), and
+ * the returned entry addresses are meant to be read through the data cache.
+ * Addresses map to themselves; only the cost of translating is modeled.
+ */
+class Tlb {
+ public:
+  enum class Result { L1Hit, L2Hit, Miss };
+
+  Tlb(const TlbConfig &config);
+
+/*
+ * Translates an address, filling both levels on a miss.
+ *
+ * Parameters:
+ *   address - The virtual address being accessed
+ *
+ * Returns:
+ *   Which level hit, or Miss if a page walk is needed.
+ */
+  Result translate(uint32_t address);
+
+/*
+ * Lists the page table entries a walk reads, from the root down.
+ *
+ * Parameters:
+ *   address - The virtual address being translated
+ *
+ * Returns:
+ *   The address of each page table entry the walk reads.
+ */
+  std::vector<uint32_t> walk(uint32_t address) const;
+
+  bool hasL2() const;
+
+ private:
+  int pageBits;
+  TlbArray l1;
+  TlbArray l2;
+  bool l2Enabled;
+};
+
+#endif
@@ -0,0 +1,245 @@
+/*
+ * Trace input and miss stream output implementations for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Libraries and Files
+#include "Trace.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+// Statements
+using std::string;
+
+// Miss stream layout
+// An 8-byte header (magic, version, block offset bits, two reserved bytes)
+// is followed by one record per memory transfer: a varint of the sequence
+// delta shifted left once with the write bit below it, then a zigzag varint
+// of the change in block number from the previous record. The magic starts
+// with a byte that never begins a text trace.
+static const char MISS_STREAM_MAGIC[4] = {'\x89', 'C', 'M', 'S'};
+static const int MISS_STREAM_VERSION = 1;
+static const int MISS_STREAM_HEADER = 8;
+static const size_t MISS_STREAM_BUFFER = 1 << 20;
+
+/*
+ * Constructor for the TraceReader class. Detects the input's format.
+ *
+ * Parameters:
+ *   in - The stream to read from
+ */
+TraceReader::TraceReader(std::istream &in)
+    : in(in), binary(false), blockBits(0), sequence(UINT64_MAX), stamp(0), block(0)
+{
+    if (in.peek() != (unsigned char)MISS_STREAM_MAGIC[0]) {
+        return;
+    }
+    binary = true;
+    char header[MISS_STREAM_HEADER];
+    if (!in.read(header, MISS_STREAM_HEADER) || !std::equal(header, header + 4, MISS_STREAM_MAGIC) ||
+        header[4] != MISS_STREAM_VERSION || header[5] < 0 || header[5] > 31) {
+        message = "Invalid miss stream header";
+        return;
+    }
+    blockBits = header[5];
+}
+
+/*
+ * Reads the next access.
+ *
+ * Parameters:
+ *   record - Set to the access
+ *   sequence - Set to the access's position in the original trace
+ *
+ * Returns:
+ *   1 if an access was read, 0 at the end of the input,
+ *   -1 on invalid input (see error()).
+ */
+int TraceReader::next(AccessRecord &record, uint64_t &sequence) {
+    if (!message.empty()) {
+        return -1;
+    }
+    record = {};
+    int status = binary ? nextRecord(record) : nextLine(record);
+    sequence = this->sequence;
+    return status;
+}
+
+/*
+ * Timestamp of the last access read: its fourth column, or its sequence
+ * number if it has none.
+ */
+uint64_t TraceReader::timestamp() const {
+    return stamp;
+}
+
+/*
+ * Describes why next() last returned -1.
+ */
+const string &TraceReader::error() const {
+    return message;
+}
+
+int TraceReader::nextLine(AccessRecord &record) {
+    string line;
+    if (!getline(in, line)) {
+        return 0;
+    }
+    std::istringstream iss(line);
+    string type;
+    string address;
+    int accessSize = 0;
+    iss >> type >> address >> accessSize;
+    if (type != "l" && type != "s") {
+        message = "Invalid type";
+        return -1;
+    }
+    // lines are counted from 1 in messages, and sequence is still the previous line's
+    try {
+        record.address = stoul(address, nullptr, 16);
+    }
+    catch (const std::invalid_argument &) {
+        message = "Invalid address on line " + std::to_string(sequence + 2);
+        return -1;
+    }
+    catch (const std::out_of_range &) {
+        message = "Invalid address on line " + std::to_string(sequence + 2);
+        return -1;
+    }
+    record.type = type[0];
+    record.size = accessSize;
+    sequence++;
+    if (!(iss >> stamp)) {
+        stamp = sequence;
+    }
+    return 1;
+}
+
+int TraceReader::nextRecord(AccessRecord &record) {
+    uint64_t head;
+    uint64_t delta;
+    int status = readVarint(head);
+    if (status == 1) {
+        status = readVarint(delta) == 1 ? 1 : -1;
+    }
+    if (status < 0) {
+        message = "Truncated miss stream";
+    }
+    if (status != 1) {
+        return status;
+    }
+    // the first record's delta is taken from sequence 0
+    sequence = (sequence == UINT64_MAX ? 0 : sequence) + (head >> 1);
+    block += (uint32_t)((delta >> 1) ^ (~(delta & 1) + 1));
+    record.address = block << blockBits;
+    record.type = (head & 1) ? 's' : 'l';
+    stamp = sequence;
+    // the whole block was moved, as far as the size column can say so
+    record.size = blockBits >= 8 ? 255 : 1 << blockBits;
+    return 1;
+}
+
+/*
+ * Reads one varint from a miss stream.
+ *
+ * Returns:
+ *   1 if a value was read, 0 at the end of the input before any byte,
+ *   -1 if the input ends inside the value.
+ */
+int TraceReader::readVarint(uint64_t &value) {
+    std::streambuf *buffer = in.rdbuf();
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = buffer->sbumpc();
+        if (byte == std::char_traits<char>::eof()) {
+            return shift == 0 ? 0 : -1;
+        }
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return 1;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Constructor for the MissStreamWriter class. Creates the file and writes
+ * its header.
+ *
+ * Parameters:
+ *   path - The file to write
+ *   blockBits - Block offset bits, so readers can rebuild addresses
+ */
+MissStreamWriter::MissStreamWriter(const string &path, int blockBits)
+    : file(fopen(path.c_str(), "wb")), sequence(0), block(0), records(0)
+{
+    if (file == nullptr) {
+        return;
+    }
+    setvbuf(file, nullptr, _IOFBF, MISS_STREAM_BUFFER);
+    char header[MISS_STREAM_HEADER] = {};
+    std::copy(MISS_STREAM_MAGIC, MISS_STREAM_MAGIC + 4, header);
+    header[4] = MISS_STREAM_VERSION;
+    header[5] = blockBits;
+    fwrite(header, 1, MISS_STREAM_HEADER, file);
+}
+
+/*
+ * Destructor for the MissStreamWriter class. Closes the file if it is open.
+ */
+MissStreamWriter::~MissStreamWriter() {
+    close();
+}
+
+bool MissStreamWriter::isOpen() const {
+    return file != nullptr;
+}
+
+/*
+ * Appends one record.
+ *
+ * Parameters:
+ *   type - 'l' for a read from memory or 's' for a write to memory
+ *   block - The block number (address without its offset bits)
+ *   sequence - Position of the causing access in the original trace
+ */
+void MissStreamWriter::write(char type, uint32_t block, uint64_t sequence) {
+    putVarint(((sequence - this->sequence) << 1) | (type == 's'));
+    int32_t delta = (int32_t)(block - this->block);
+    putVarint(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+    this->sequence = sequence;
+    this->block = block;
+    records++;
+}
+
+/*
+ * Flushes and closes the file.
+ *
+ * Returns:
+ *   True if every record reached the file, False otherwise.
+ */
+bool MissStreamWriter::close() {
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = !ferror(file);
+    ok = fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+uint64_t MissStreamWriter::count() const {
+    return records;
+}
+
+void MissStreamWriter::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        putc((int)(value & 0x7f) | 0x80, file);
+        value >>= 7;
+    }
+    putc((int)value, file);
+}
@@ -0,0 +1,138 @@
+/*
+ * Trace input and miss stream output for a cache simulator
+ * CSF Assignment 3
+ * Lawrence Cai and Benjamin Chang
+ * lcai18@jh.edu bchang26@jhu.edu
+ */
+
+// Guards
+#ifndef TRACE_H
+#define TRACE_H
+
+// Libraries and Files
+#include <stdint.h>
+#include <stdio.h>
+
+#include <iostream>
+#include <string>
+
+#include "Simulator.h"
+
+// Class Definitions
+/*
+ * Reads accesses from a text trace or from a miss stream written by another
+ * run, telling the two apart by the stream's first byte. Text lines are
+ * numbered from 0; a miss stream keeps the sequence numbers it was written
+ * with, so a cascade of runs still points back at the original trace.
+ * A text line may carry a fourth column, a decimal timestamp.
+ */
+class TraceReader {
+ public:
+  /*
+ * Constructor for the TraceReader class. Detects the input's format.
+ *
+ * Parameters:
+ *   in - The stream to read from
+ */
+  explicit TraceReader(std::istream &in);
+
+/*
+ * Reads the next access.
+ *
+ * Parameters:
+ *   record - Set to the access
+ *   sequence - Set to the access's position in the original trace
+ *
+ * Returns:
+ *   1 if an access was read, 0 at the end of the input,
+ *   -1 on invalid input (see error()).
+ */
+  int next(AccessRecord &record, uint64_t &sequence);
+
+/*
+ * Timestamp of the last access read: its fourth column, or its sequence
+ * number if it has none.
+ */
+  uint64_t timestamp() const;
+
+/*
+ * Describes why next() last returned -1.
+ */
+  const std::string &error() const;
+
+ private:
+  /* Variables */
+  std::istream &in;
+  bool binary;
+  int blockBits;      // block offset bits of the run that wrote the stream
+  uint64_t sequence;  // of the last access read
+  uint64_t stamp;     // of the last access read
+  uint32_t block;     // of the last access read, for miss streams
+  std::string message;
+
+  /* Methods */
+  int nextLine(AccessRecord &record);
+  int nextRecord(AccessRecord &record);
+  int readVarint(uint64_t &value);
+};
+
+/*
+ * Writes a run's memory reads and writes as a miss stream. Each record holds
+ * the operation, the block number and the sequence number of the trace
+ * access that caused it, delta encoded as varints, so a filtered trace
+ * usually takes two or three bytes per record.
+ */
+class MissStreamWriter {
+ public:
+  /*
+ * Constructor for the MissStreamWriter class. Creates the file and writes
+ * its header.
+ *
+ * Parameters:
+ *   path - The file to write
+ *   blockBits - Block offset bits, so readers can rebuild addresses
+ */
+  MissStreamWriter(const std::string &path, int blockBits);
+
+  /*
+ * Destructor for the MissStreamWriter class. Closes the file if it is open.
+ */
+  ~MissStreamWriter();
+
+  MissStreamWriter(const MissStreamWriter &) = delete;
+  MissStreamWriter &operator=(const MissStreamWriter &) = delete;
+
+  bool isOpen() const;
+
+/*
+ * Appends one record.
+ *
+ * Parameters:
+ *   type - 'l' for a read from memory or 's' for a write to memory
+ *   block - The block number (address without its offset bits)
+ *   sequence - Position of the causing access in the original trace
+ */
+  void write(char type, uint32_t block, uint64_t sequence);
+
+/*
+ * Flushes and closes the file.
+ *
+ * Returns:
+ *   True if every record reached the file, False otherwise.
+ */
+  bool close();
+
+  uint64_t count() const;
+
+ private:
+  /* Variables */
+  FILE *file;
+  uint64_t sequence;  // of the last record written
+  uint32_t block;     // of the last record written
+  uint64_t records;
+
+  /* Methods */
+  void putVarint(uint64_t value);
+};
+
+#endif